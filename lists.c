@@ -19,864 +19,7516 @@
  * $Id: lists.c,v 0.7 2013-05-25 00:03:59 jon Exp $
  */
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <time.h>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#define LISTS_MMAP
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/uio.h>
+#include <unistd.h>
+#define LISTS_WRITEV
+#elif defined(_WIN32)
+#include <io.h>
+#endif
+
+#ifndef LISTS_NO_THREADS
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#ifndef LISTS_NO_USDT
+#if defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define LISTS_USDT
+#endif
+#endif
+#endif
 
 #include "lists.h"
 
 /***************************
- *  Integer List functions
+ *  List buffer functions
  */
-int IntListInit(IntListPtr list, long reserve, long grow)
+
+/* Hidden header in front of every list buffer */
+typedef struct {
+	size_t size;
+	size_t map;
+	size_t offset;
+	size_t align;
+	size_t commit;
+	size_t fixed;
+} ListsBlockType;
+
+static size_t lists_align = 0, lists_huge = 0;
+
+void ListsSetAlign(size_t align)
 {
-	list->start = list->ptr = NULL;
-	list->reserve = list->grow = 0;
+	/* Anything below malloc's own 16 bytes, or not a power of two, means no extra alignment */
+	lists_align = align > 16 && !(align & (align - 1)) ? align : 0;
+}
 
-	if(reserve && (list->start = list->ptr = (long *)malloc(reserve * sizeof(long))) == NULL)
-		return(FALSE);
+void ListsSetHugePage(size_t threshold)
+{
+	lists_huge = threshold;
+}
 
-	list->reserve = reserve;
-	list->grow = grow;
+/* Elements ahead of the current one whose payloads pointer-chasing loops prefetch */
+static unsigned long lists_prefetch = LISTS_PREFETCH;
 
-	return(TRUE);
+void ListsSetPrefetch(unsigned long distance)
+{
+	lists_prefetch = distance;
 }
 
-void IntListFree(IntListPtr list)
+#if defined(__GNUC__) || defined(__clang__)
+#define lists_prefetch_addr(addr)	__builtin_prefetch(addr, 0, 3)
+#else
+#define lists_prefetch_addr(addr)	((void)(addr))
+#endif
+
+static ListsMallocFunc *lists_malloc_func = malloc;
+static ListsReallocFunc *lists_realloc_func = realloc;
+static ListsFreeFunc *lists_free_func = free;
+
+/* Aligned and mapped list buffers bypass the hooks; everything else goes through them */
+void ListsSetAllocator(ListsMallocFunc *malloc_func, ListsReallocFunc *realloc_func, ListsFreeFunc *free_func)
 {
-	if(list->start)
-	{
-		free(list->start);
-		list->start = NULL;
-	}
+	lists_malloc_func = malloc_func ? malloc_func : malloc;
+	lists_realloc_func = realloc_func ? realloc_func : realloc;
+	lists_free_func = free_func ? free_func : free;
+}
 
-	list->ptr = NULL;
-	list->reserve = 0;
-	list->grow = 0;
+void *lists_malloc(size_t size)
+{
+	return(lists_malloc_func(size));
 }
 
-void IntListDump(IntListPtr list, FILE *stream, int type)
+void *lists_calloc(size_t count, size_t size)
 {
-	if(type) {
-		fprintf(stream, "Integer List [0x%p]\n", list);
-		fprintf(stream, " |--Start: 0x%p\n", list->start);
-		fprintf(stream, " |--Pointer: 0x%p(+%zu)\n", list->ptr, list->ptr - list->start);
-		fprintf(stream, " |--Reserve: %lu\n", list->reserve);
-		fprintf(stream, " +--Grow: +%lu\n\n", list->grow);
-	} else
-		fprintf(stream, "Integer List [0x%p] Data: [0x%p:+%zu], Reserve [%lu:+%lu]\n",
-				list, list->start, list->ptr - list->start,
-				list->reserve, list->grow);
+	void *ptr;
+
+	if(size && count > (size_t)-1 / size)
+		return(NULL);
+
+	if((ptr = lists_malloc_func(count * size)) != NULL)
+		memset(ptr, 0, count * size);
+
+	return(ptr);
 }
 
-long intlist_print(IntListPtr list, long index, long value, void *custom)
+void *lists_realloc(void *ptr, size_t size)
 {
-	fprintf(custom, "%ld ", value);
-	return(value);
+	return(lists_realloc_func(ptr, size));
 }
 
-void IntListPrint(IntListPtr list, FILE *stream, IntListMapFunc func)
+void lists_free(void *ptr)
 {
-	fprintf(stream, "[ ");
-	IntListMap(list, func ? func : intlist_print, stream);
-	fprintf(stream, "]\n");
+	lists_free_func(ptr);
 }
 
-int IntListReserve(IntListPtr list, unsigned long size, unsigned long grow)
+static size_t lists_bytes = 0, lists_budget = 0;
+
+void ListsSetBudget(size_t bytes)
 {
-	unsigned long index = list->ptr - list->start;
-	long *ptr;
+	lists_budget = bytes;
+}
 
-	if(!size)
-		size = index;
+size_t ListsBytes(void)
+{
+	return(lists_bytes);
+}
 
-	if(grow)
-		list->grow = grow;
+#define LISTS_REGISTER_INT	0
+#define LISTS_REGISTER_VOID	1
 
-	if(size < index)
-		size = index;
+/* Lists that ListsTrimAll shrinks */
+typedef struct {
+	void *list;
+	int type;
+} ListsRegisterType;
 
-	size = (size / list->grow + 1) * list->grow;
+static ListsRegisterType *lists_register_entry = NULL;
+static unsigned long lists_register_count = 0, lists_register_reserve = 0;
 
-	if(size < list->grow)
-		size = list->grow;
+int lists_register(void *list, int type)
+{
+	ListsRegisterType *entry;
+	unsigned long i;
 
-	if((ptr = realloc(list->start, size * sizeof(long))) == NULL)
-		return(FALSE);
+	for(i = 0; i < lists_register_count; i++)
+		if(lists_register_entry[i].list == list)
+			return(TRUE);
 
-	list->start = ptr;
-	list->ptr = ptr + index;
-	list->reserve = size;
+	if(lists_register_count == lists_register_reserve) {
+		if((entry = lists_realloc(lists_register_entry,
+				(lists_register_reserve * 2 + 16) * sizeof(ListsRegisterType))) == NULL)
+			return(FALSE);
+		lists_register_entry = entry;
+		lists_register_reserve = lists_register_reserve * 2 + 16;
+	}
+
+	lists_register_entry[lists_register_count].list = list;
+	lists_register_entry[lists_register_count++].type = type;
 
 	return(TRUE);
 }
 
-long IntListSize(IntListPtr list)
+int ListsUnregister(void *list)
 {
-	return(list->ptr - list->start);
+	unsigned long i;
+
+	for(i = 0; i < lists_register_count; i++)
+		if(lists_register_entry[i].list == list) {
+			lists_register_entry[i] = lists_register_entry[--lists_register_count];
+			if(!lists_register_count) {
+				lists_free(lists_register_entry);
+				lists_register_entry = NULL;
+				lists_register_reserve = 0;
+			}
+			return(TRUE);
+		}
+
+	return(FALSE);
 }
 
-int IntListRemove(IntListPtr list, long index, unsigned long size)
+size_t ListsTrimAll(void)
 {
-	long *dest = list->start + index, *src = dest + size;
-
-	if(!size || src > list->ptr)
-		return(FALSE);
-
-	if(src < list->ptr)
-		memmove(dest, src, (list->ptr - src) * sizeof(long));
+	size_t bytes = lists_bytes;
+	unsigned long i;
 
-	list->ptr -= size;
+	for(i = 0; i < lists_register_count; i++)
+		if(lists_register_entry[i].type == LISTS_REGISTER_INT)
+			IntListTrim(lists_register_entry[i].list);
+		else
+			VoidListTrim(lists_register_entry[i].list);
 
-	IntListReserve(list, 0, 0);
+	return(bytes > lists_bytes ? bytes - lists_bytes : 0);
+}
 
-	return(TRUE);
+ListsBlockType *lists_block(void *buffer)
+{
+	return(buffer ? (ListsBlockType *)buffer - 1 : NULL);
 }
 
-int IntListResize(IntListPtr list, unsigned long size, long value)
+void *lists_block_init(char *base, size_t size, size_t map, size_t offset, size_t align)
 {
-	unsigned long index = list->ptr - list->start;
-	long *ptr;
+	ListsBlockType *block = (ListsBlockType *)(base + offset) - 1;
 
-	if(size == index)
-		return(TRUE);
+	block->size = size;
+	block->map = map;
+	block->offset = offset;
+	block->align = align;
+	block->commit = map;
+	block->fixed = FALSE;
 
-	if(size < index)
-		return(IntListRemove(list, size, index - size));
+	return(block + 1);
+}
 
-	IntListReserve(list, size, 0);
-	ptr = list->start + size;
-	while(list->ptr < ptr)
-		*list->ptr++ = value;
+/* Header room before the data: the header itself, rounded up to a whole number of alignment units */
+size_t lists_block_offset(size_t align)
+{
+	if(!align)
+		return(sizeof(ListsBlockType));
 
-	return(TRUE);
+	return((sizeof(ListsBlockType) + align - 1) & ~(align - 1));
 }
 
-int IntListPush(IntListPtr list, long value)
+/* Largest size a buffer can be grown to without moving, for fixed buffers */
+size_t lists_buffer_limit(void *buffer)
 {
-	if(list->ptr >= list->start + list->reserve)
-		if(!IntListReserve(list, 0, 0))
-			return(FALSE);
+	ListsBlockType *block = lists_block(buffer);
 
-	*list->ptr = value;
-	list->ptr++;
+	if(!block || !block->fixed)
+		return((size_t)-1);
 
-	return(TRUE);
+	return(block->map - block->offset);
 }
 
-int IntListPop(IntListPtr list, long *value)
+/* Returns a buffer's memory without touching the byte count */
+void lists_buffer_release(void *buffer)
 {
-	unsigned long size;
-
-	if(list->ptr <= list->start)
-		return(FALSE);
+	ListsBlockType *block = lists_block(buffer);
 
-	list->ptr--;
+#ifdef LISTS_MMAP
+	if(block->map) {
+		munmap((char *)buffer - block->offset, block->map);
+		return;
+	}
+#endif
 
-	if(value)
-		*value = *list->ptr;
+	if(block->align)
+		free((char *)buffer - block->offset);
+	else
+		lists_free((char *)buffer - block->offset);
+}
 
-	if(list->reserve - (list->grow << 1) >= (size = list->ptr - list->start))
-		IntListReserve(list, size, 0);
+#ifdef LISTS_MMAP
+size_t lists_page(size_t size)
+{
+	size_t page = sysconf(_SC_PAGESIZE);
 
-	return(TRUE);
+	return((size + page - 1) / page * page);
 }
 
-long *IntListPointer(IntListPtr list, long index)
+/* Moves a buffer into a PROT_NONE reservation of max bytes, committing only what it uses */
+void *lists_buffer_reserve(void *buffer, size_t max)
 {
-	long *ptr = (index < 0 ? list->ptr : list->start) + index;
+	ListsBlockType *block = lists_block(buffer);
+	size_t size = block ? block->size : 0, align = lists_align,
+			offset = lists_block_offset(align),
+			map = lists_page(offset + max), commit = lists_page(offset + size);
+	char *base;
 
-	if(ptr < list->start || ptr >= list->ptr)
+	if(size > max)
 		return(NULL);
 
-	return(ptr);
-}
+	if((base = mmap(NULL, map, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0)) == MAP_FAILED)
+		return(NULL);
 
-int IntListSet(IntListPtr list, long index, long value)
-{
-	long *ptr;
+	if(mprotect(base, commit, PROT_READ | PROT_WRITE)) {
+		munmap(base, map);
+		return(NULL);
+	}
 
-	if(!(ptr = IntListPointer(list, index)))
-		return(FALSE);
+#ifdef MADV_HUGEPAGE
+	if(lists_huge && map >= lists_huge)
+		madvise(base, map, MADV_HUGEPAGE);
+#endif
 
-	*ptr = value;
+	if(block) {
+		memcpy(base + offset, buffer, size);
+		lists_buffer_release(buffer);
+	}
 
-	return(TRUE);
+	buffer = lists_block_init(base, size, map, offset, align);
+	block = lists_block(buffer);
+	block->commit = commit;
+	block->fixed = TRUE;
+
+	return(buffer);
 }
 
-int IntListGet(IntListPtr list, long index, long *value)
+/* Fixed buffers never move: growth commits pages, shrinking hands them back */
+void *lists_buffer_commit(void *buffer, size_t size)
 {
-	long *ptr;
+	ListsBlockType *block = lists_block(buffer);
+	size_t commit = lists_page(block->offset + size);
+	char *base = (char *)buffer - block->offset;
 
-	if(!(ptr = IntListPointer(list, index)))
-		return(FALSE);
+	if(commit > block->map)
+		return(NULL);
 
-	if(value)
-		*value = *ptr;
+	if(commit > block->commit) {
+		if(mprotect(base + block->commit, commit - block->commit, PROT_READ | PROT_WRITE))
+			return(NULL);
+	} else if(commit < block->commit) {
+		madvise(base + commit, block->commit - commit, MADV_DONTNEED);
+		mprotect(base + commit, block->commit - commit, PROT_NONE);
+	}
 
-	return(TRUE);
+	block->commit = commit;
+	block->size = size;
+
+	return(buffer);
 }
 
-long IntListFind(IntListPtr list, long value)
+void *lists_buffer_map(void *buffer, size_t size, size_t offset)
 {
-	long *ptr = list->ptr;
+	ListsBlockType *block = lists_block(buffer);
+	size_t page = sysconf(_SC_PAGESIZE), map = (offset + size + page - 1) / page * page;
+	char *base;
+
+	if(block && block->map) {
+		/* Let the kernel move the pages rather than copying them */
+		offset = block->offset;
+		map = (offset + size + page - 1) / page * page;
+		if((base = mremap((char *)buffer - offset, block->map, map, MREMAP_MAYMOVE)) == MAP_FAILED)
+			return(NULL);
+	} else {
+		if((base = mmap(NULL, map, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)) == MAP_FAILED)
+			return(NULL);
+		if(block) {
+			memcpy(base + offset, buffer, block->size < size ? block->size : size);
+			lists_buffer_release(buffer);
+		}
+	}
 
-	while(--ptr >= list->start)
-		if(*ptr == value)
-			return(ptr - list->start);
+#ifdef MADV_HUGEPAGE
+	madvise(base, map, MADV_HUGEPAGE);
+#endif
 
-	return(-1);
+	return(lists_block_init(base, size, map, offset, lists_align));
 }
+#endif
 
-int IntListReverse(IntListPtr list, long index, unsigned long size)
+void *lists_buffer_resize(void *buffer, size_t size)
 {
-	long tmp, *ptr[2];
-	unsigned long list_size = list->ptr - list->start;
+	ListsBlockType *block = lists_block(buffer);
+	size_t align = lists_align,
+			offset = lists_block_offset(align);
+	char *base;
 
-	if(!list_size || index + size > list_size)
-		return(FALSE);
+#ifdef LISTS_MMAP
+	if(block && block->fixed)
+		return(lists_buffer_commit(buffer, size));
 
-	if(!size)
-		size = list_size - index;
+	/* Large buffers are mapped; mapped ones stay so until they halve below the threshold */
+	if(lists_huge && (offset + size >= lists_huge || (block && block->map && offset + size >= lists_huge >> 1)))
+		return(lists_buffer_map(buffer, size, offset));
+#endif
 
-	if(size < 2)
-		return(TRUE);
+	if(block && !block->map && !block->align && !align) {
+		if((base = lists_realloc((char *)buffer - block->offset, offset + size)) == NULL)
+			return(NULL);
 
-	if(!(ptr[0] = IntListPointer(list, index)))
-		return(FALSE);
+		return(lists_block_init(base, size, 0, offset, 0));
+	}
 
-	ptr[1] = ptr[0] + size - 1;
+	if(align) {
+		if(posix_memalign((void **)&base, align, offset + size))
+			return(NULL);
+	} else if((base = lists_malloc(offset + size)) == NULL)
+		return(NULL);
 
-	while(ptr[0] < ptr[1]) {
-		memcpy(&tmp, ptr[1], sizeof(long));
-		memcpy(ptr[1], ptr[0], sizeof(long));
-		memcpy(ptr[0], &tmp, sizeof(long));
-		ptr[0]++, ptr[1]--;
+	if(block) {
+		memcpy(base + offset, buffer, block->size < size ? block->size : size);
+		lists_buffer_release(buffer);
 	}
 
-	return(TRUE);
+	return(lists_block_init(base, size, 0, offset, align));
 }
 
-int IntListRotate(IntListPtr list, long amount, long index, unsigned long size)
+/* Grows or shrinks a buffer, counting its bytes against the global budget */
+void *lists_buffer_realloc(void *buffer, size_t size)
 {
-	long *tmp, *ptr[2];
-	unsigned long list_size = list->ptr - list->start;
-
-	if(!list_size || index + size > list_size)
-		return(FALSE);
-
-	if(!size)
-		size = list_size - index;
-
-	if(size < 2)
-		return(TRUE);
-
-	if(!(ptr[0] = IntListPointer(list, index)))
-		return(FALSE);
-
-	ptr[1] = ptr[0] + size;
+	size_t old = buffer ? lists_block(buffer)->size : 0;
 
-	if((tmp = malloc(labs(amount) * sizeof(long))) == NULL)
-		return(FALSE);
+	if(lists_budget && size > old && lists_bytes - old + size > lists_budget)
+		return(NULL);
 
-	if(amount > 0) {
-		memcpy(tmp, ptr[1] - amount, sizeof(long) * amount);
-		memmove(ptr[0] + amount, ptr[0], sizeof(long) * (size - amount));
-		memcpy(ptr[0], tmp, sizeof(long) * amount);
-	} else {
-		amount = -amount;
-		memcpy(tmp, ptr[0], sizeof(long) * amount);
-		memmove(ptr[0], ptr[0] + amount, sizeof(long) * (size - amount));
-		memcpy(ptr[1] - amount, tmp, sizeof(long) * amount);
-	}
+	if((buffer = lists_buffer_resize(buffer, size)) == NULL)
+		return(NULL);
 
-	free(tmp);
+	lists_bytes = lists_bytes - old + size;
 
-	return(TRUE);
+	return(buffer);
 }
 
-int IntListCopy(IntListPtr dest, IntListPtr src, long index, unsigned long size)
+void lists_buffer_free(void *buffer)
 {
-	long *ptr;
-	unsigned long dest_size = dest->ptr - dest->start,
-			src_size = src->ptr - src->start;
+	ListsBlockType *block = lists_block(buffer);
 
-	if(index + size > src_size)
-		return(FALSE);
+	if(!block)
+		return;
 
-	if(!(ptr = IntListPointer(src, index)))
-		return(FALSE);
+	lists_bytes -= block->size;
+	lists_buffer_release(buffer);
+}
 
-	if(!size)
-		size = src_size - index;
 
-	if(!IntListReserve(dest, dest_size + size, src->grow))
-		return(FALSE);
 
-	memmove(dest->ptr, ptr, sizeof(long) * size);
+/***************************
+ *  List tracing functions
+ */
 
-	dest->ptr += size;
+/* USDT probes: nops in the code until perf or bpftrace attaches to provider "lists" */
+#ifdef LISTS_USDT
+#define LISTS_PROBE2(name, a, b)		DTRACE_PROBE2(lists, name, a, b)
+#define LISTS_PROBE3(name, a, b, c)		DTRACE_PROBE3(lists, name, a, b, c)
+#define LISTS_PROBE4(name, a, b, c, d)	DTRACE_PROBE4(lists, name, a, b, c, d)
+#else
+#define LISTS_PROBE2(name, a, b)		((void)(a), (void)(b))
+#define LISTS_PROBE3(name, a, b, c)		((void)(a), (void)(b), (void)(c))
+#define LISTS_PROBE4(name, a, b, c, d)	((void)(a), (void)(b), (void)(c), (void)(d))
+#endif
+
+static const char *lists_op_name[LISTS_OPS] = {
+	"reserve", "remove", "filter", "rotate", "copy", "alloc", "free"
+};
+
+static int lists_histogram_enable = FALSE;
+static unsigned long lists_histogram[LISTS_OPS][LISTS_HISTOGRAM_BUCKETS];
+
+void ListsHistogramEnable(int enable)
+{
+	lists_histogram_enable = enable;
+}
 
-	return(TRUE);
+void ListsHistogramReset(void)
+{
+	memset(lists_histogram, 0, sizeof(lists_histogram));
 }
 
-int IntListMove(IntListPtr dest, IntListPtr src, long index, unsigned long size)
+/* Copies the counts of one operation; bucket b holds calls taking [2^(b-1), 2^b) ns */
+int ListsHistogramGet(int op, unsigned long *counts)
 {
-	if(!(IntListCopy(dest, src, index, size)))
+	if(op < 0 || op >= LISTS_OPS)
 		return(FALSE);
 
-	if(!IntListResize(src, 0, 0))
-		return(FALSE);
+	memcpy(counts, lists_histogram[op], sizeof(lists_histogram[op]));
 
 	return(TRUE);
 }
 
-/* Int List mapping functions */
-int IntListMap(IntListPtr list, IntListMapFunc map_func, void *custom)
+void ListsHistogramDump(FILE *stream)
 {
-	long *ptr = list->start, index = 0;
-
-	while(ptr < list->ptr) {
-		*ptr = map_func(list, index++, *ptr, custom);
-		ptr++;
+	unsigned long total;
+	int op, b;
+
+	for(op = 0; op < LISTS_OPS; op++) {
+		for(total = 0, b = 0; b < LISTS_HISTOGRAM_BUCKETS; b++)
+			total += lists_histogram[op][b];
+		if(!total)
+			continue;
+
+		fprintf(stream, "%s: %lu calls\n", lists_op_name[op], total);
+		for(b = 0; b < LISTS_HISTOGRAM_BUCKETS; b++)
+			if(lists_histogram[op][b])
+				fprintf(stream, "  %12lu - %-12lu ns %12lu\n",
+						b ? 1UL << (b - 1) : 0, (1UL << b) - 1 + !b, lists_histogram[op][b]);
 	}
-
-	return(TRUE);
 }
 
-int IntListFilter(IntListPtr list, IntListFilterFunc filter_func, void *custom)
+/* Start time in ns, or 0 while histograms are off */
+unsigned long lists_trace_start(void)
 {
-	long *ptr = list->ptr, n;
+	struct timespec ts;
 
-	while(--ptr >= list->start)
-		if(!filter_func(list, *ptr, custom))
-			if((n = --list->ptr - ptr))
-				memmove(ptr, ptr + 1, n * sizeof(long));
+	if(!lists_histogram_enable)
+		return(0);
 
-	return(TRUE);
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return(ts.tv_sec * 1000000000UL + ts.tv_nsec + 1);
 }
 
-int IntListReduce(IntListPtr list, IntListReduceFunc reduce_func, long *value, long initial, void *custom)
+void lists_trace_stop(int op, unsigned long start)
 {
-	long *ptr = list->ptr;
+	unsigned long ns;
+	int b = 0;
 
-	while(--ptr >= list->start)
-		initial = reduce_func(list, initial, *ptr, custom);
+	if(!start)
+		return;
 
-	if(value)
-		*value = initial;
+	ns = lists_trace_start() - start;
+	while(ns >> b && b < LISTS_HISTOGRAM_BUCKETS - 1)
+		b++;
 
-	return(TRUE);
+	lists_histogram[op][b]++;
 }
 
 
 
-/************************
- *  Void List functions
+/***************************
+ *  List sorting functions
  */
-int VoidListInit(VoidListPtr list, long reserve, long grow, size_t width,
-		VoidListAllocFunc alloc_func, VoidListFreeFunc free_func,
-		VoidListCpyFunc cpy_func, VoidListCmpFunc cmp_func)
+#define LISTS_SORT_SAMPLES	64		/* samples per bucket when picking splitters */
+#define LISTS_SORT_MIN		65536	/* smaller lists sort on one thread */
+
+struct ListsSortStruct;
+typedef int (ListsSortCmpFunc)(struct ListsSortStruct *job, const void *ptr1, const void *ptr2);
+
+/* Shared state of one sample sort or deduplicate, split across threads */
+typedef struct ListsSortStruct {
+	char *start;
+	char *tmp;
+	unsigned long size;
+	size_t width;
+	int threads;
+	ListsSortCmpFunc *cmp_func;
+	VoidListPtr list;
+	char *splitter;
+	unsigned long *count;
+	unsigned long *kept;
+	char *prev;
+} ListsSortType;
+typedef ListsSortType *ListsSortPtr;
+
+typedef struct {
+	ListsSortPtr job;
+	int thread;
+	void (*func)(ListsSortPtr job, int thread);
+} ListsTaskType;
+
+int lists_sort_long(ListsSortPtr job, const void *ptr1, const void *ptr2)
 {
-	list->start = list->ptr = NULL;
-	list->reserve = list->grow = 0;
+	long a = *(const long *)ptr1, b = *(const long *)ptr2;
 
-	if(reserve && (list->start = list->ptr = (void **)malloc(reserve * sizeof(void *))) == NULL)
-		return(FALSE);
+	return((a > b) - (a < b));
+}
 
-	list->reserve = reserve;
-	list->grow = grow;
-	list->width = width;
-	list->alloc_func = alloc_func ? alloc_func : voidlist_alloc;
-	list->free_func = free_func ? free_func : voidlist_free;
-	list->cpy_func = cpy_func ? cpy_func : voidlist_cpy;
-	list->cmp_func = cmp_func ? cmp_func : voidlist_cmp;
+int lists_sort_void(ListsSortPtr job, const void *ptr1, const void *ptr2)
+{
+	return(job->list->cmp_func(job->list, *(void * const *)ptr1, *(void * const *)ptr2, job->list->width));
+}
 
-	return(TRUE);
+int lists_sort_bytes(ListsSortPtr job, const void *ptr1, const void *ptr2)
+{
+	return(memcmp(ptr1, ptr2, job->width));
 }
 
-void VoidListFree(VoidListPtr list)
+int lists_qsort_long(const void *ptr1, const void *ptr2)
 {
-	if(list->free_func) {
-		while(list->ptr > list->start)
-			list->free_func(list, *--list->ptr);
+	return(lists_sort_long(NULL, ptr1, ptr2));
+}
 
-		free(list->start);
-		list->start = NULL;
+/* Stable merge sort of void pointers through the list's cmp_func, tmp holds size entries */
+void voidlist_merge_sort(VoidListPtr list, void **ptr, void **tmp, unsigned long size)
+{
+	unsigned long half = size / 2, a, b, n;
+	void *value;
+
+	if(size < 16) {
+		for(a = 1; a < size; a++) {
+			value = ptr[a];
+			for(b = a; b && list->cmp_func(list, ptr[b - 1], value, list->width) > 0; b--)
+				ptr[b] = ptr[b - 1];
+			ptr[b] = value;
+		}
+		return;
 	}
 
-	list->reserve = 0;
-	list->grow = 0;
-	list->width = 0;
-	list->alloc_func = NULL;
-	list->free_func = NULL;
-	list->cpy_func = NULL;
-	list->cmp_func = NULL;
-}
+	voidlist_merge_sort(list, ptr, tmp, half);
+	voidlist_merge_sort(list, ptr + half, tmp, size - half);
 
-void _VoidListDump(VoidListPtr list, FILE *stream, int type, char *name)
-{
-	if(type) {
-		fprintf(stream, "%s[0x%p]\n", name, list);
-		fprintf(stream, " |--Start: 0x%p\n", list->start);
-		fprintf(stream, " |--Pointer: 0x%p(+%zu)\n", list->ptr, list->ptr - list->start);
-		fprintf(stream, " |--Reserve: %lu units\n", list->reserve);
-		fprintf(stream, " |--Grow: +%lu units\n\n", list->grow);
-		fprintf(stream, " +--Width: +%zu bytes\n\n", list->width);
-	} else
-		fprintf(stream, "%s[0x%p] Data: [0x%p:+%zu], Reserve [%lu:+%lu], Width [%zu b.]\n",
-				name, list, list->start, list->ptr - list->start,
-				list->reserve, list->grow, list->width);
+	if(list->cmp_func(list, ptr[half - 1], ptr[half], list->width) <= 0)
+		return;
+
+	for(a = 0, b = half, n = 0; a < half && b < size; n++)
+		tmp[n] = list->cmp_func(list, ptr[a], ptr[b], list->width) <= 0 ? ptr[a++] : ptr[b++];
+	while(a < half)
+		tmp[n++] = ptr[a++];
+
+	memcpy(ptr, tmp, n * sizeof(void *));
 }
 
-void VoidListDump(VoidListPtr list, FILE *stream, int type)
+/* Sorts size elements in place on one thread */
+void lists_sort_range(ListsSortPtr job, char *ptr, char *tmp, unsigned long size)
 {
-	_VoidListDump(list, stream, type, "Void List");
+	if(job->list)
+		voidlist_merge_sort(job->list, (void **)ptr, (void **)tmp, size);
+	else
+		qsort(ptr, size, sizeof(long), lists_qsort_long);
 }
 
-void *voidlist_print(VoidListPtr list, long index, void *value, void *custom)
+int lists_threads(int threads)
 {
-	fprintf(custom, "0x%p ", value);
-	return(value);
+#ifndef LISTS_NO_THREADS
+	long cpus;
+
+	if(threads <= 0)
+		threads = (cpus = sysconf(_SC_NPROCESSORS_ONLN)) > 0 ? cpus : 1;
+#else
+	threads = 1;
+#endif
+
+	return(threads);
 }
 
-void VoidListPrint(VoidListPtr list, FILE *stream, VoidListMapFunc func)
+#ifndef LISTS_NO_THREADS
+void *lists_task(void *arg)
 {
-	fprintf(stream, "[ ");
-	VoidListMap(list, func ? func : voidlist_print, stream);
-	fprintf(stream, "]\n");
+	ListsTaskType *task = arg;
+
+	task->func(task->job, task->thread);
+
+	return(NULL);
 }
+#endif
 
-int VoidListReserve(VoidListPtr list, unsigned long size, unsigned long grow, size_t width)
+/* Runs func once per thread of the job, the calling thread taking thread 0 */
+int lists_parallel(ListsSortPtr job, void (*func)(ListsSortPtr job, int thread))
 {
-	unsigned long index = list->ptr - list->start;
-	void **ptr;
-
-	if(!size)
-		size = index;
+#ifndef LISTS_NO_THREADS
+	pthread_t *tid;
+	ListsTaskType *task;
+	int t, started;
 
-	if(grow)
-		list->grow = grow;
+	if(job->threads > 1) {
+		if((tid = lists_malloc(job->threads * (sizeof(pthread_t) + sizeof(ListsTaskType)))) == NULL)
+			return(FALSE);
+		task = (ListsTaskType *)(tid + job->threads);
 
-	if(size < index)
-		size = index;
+		for(t = 0; t < job->threads; t++) {
+			task[t].job = job;
+			task[t].thread = t;
+			task[t].func = func;
+		}
 
-	size = (size / list->grow + 1) * list->grow;
+		/* Threads that fail to start run on this one instead */
+		for(started = 1; started < job->threads; started++)
+			if(pthread_create(tid + started, NULL, lists_task, task + started))
+				break;
+		for(t = started; t < job->threads; t++)
+			func(job, t);
+		func(job, 0);
 
-	if(size < list->grow)
-		size = list->grow;
+		for(t = 1; t < started; t++)
+			pthread_join(tid[t], NULL);
 
-	if((ptr = realloc(list->start, size * sizeof(void *))) == NULL)
-		return(FALSE);
+		lists_free(tid);
+		return(TRUE);
+	}
+#endif
 
-	list->start = ptr;
-	list->ptr = ptr + index;
-	list->reserve = size;
-	if(width)
-		list->width = width;
+	func(job, 0);
 
 	return(TRUE);
 }
 
-long VoidListSize(VoidListPtr list)
+/* Number of splitters not above the element, which is its bucket */
+int lists_sort_bucket(ListsSortPtr job, const char *ptr)
 {
-	return(list->ptr - list->start);
+	int lo = 0, hi = job->threads - 1, mid;
+
+	while(lo < hi) {
+		mid = (lo + hi) / 2;
+		if(job->cmp_func(job, job->splitter + mid * job->width, ptr) <= 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return(lo);
 }
 
-int VoidListRemove(VoidListPtr list, long index, long size)
+void lists_sort_count(ListsSortPtr job, int thread)
 {
-	void **dest = list->start + index, **src = dest + size, **ptr = dest;
-	long n = size;
-
-	if(!size || src > list->ptr)
-		return(FALSE);
+	unsigned long *count = job->count + thread * job->threads;
+	char *ptr = job->start + job->size * thread / job->threads * job->width,
+			*end = job->start + job->size * (thread + 1) / job->threads * job->width;
 
-	while(n--)
-		list->free_func(list, *ptr++);
+	for(; ptr < end; ptr += job->width)
+		count[lists_sort_bucket(job, ptr)]++;
+}
 
-	if(src < list->ptr)
-		memmove(dest, src, (list->ptr - src) * sizeof(void *));
+void lists_sort_scatter(ListsSortPtr job, int thread)
+{
+	unsigned long *count = job->count + thread * job->threads;
+	char *ptr = job->start + job->size * thread / job->threads * job->width,
+			*end = job->start + job->size * (thread + 1) / job->threads * job->width;
 
-	list->ptr -= size;
+	for(; ptr < end; ptr += job->width)
+		memcpy(job->tmp + count[lists_sort_bucket(job, ptr)]++ * job->width, ptr, job->width);
+}
 
-	VoidListReserve(list, index + size, 0, 0);
+/* Each bucket is copied home and sorted there, using its own span of tmp as scratch */
+void lists_sort_bucket_sort(ListsSortPtr job, int thread)
+{
+	unsigned long first = thread ? job->count[(job->threads - 1) * job->threads + thread - 1] : 0,
+			last = job->count[(job->threads - 1) * job->threads + thread];
 
-	return(TRUE);
+	memcpy(job->start + first * job->width, job->tmp + first * job->width, (last - first) * job->width);
+	lists_sort_range(job, job->start + first * job->width, job->tmp + first * job->width, last - first);
 }
 
-int VoidListResize(VoidListPtr list, unsigned long size, void *value, size_t width)
+/* Parallel sample sort: pick splitters, count, scatter into buckets, sort buckets; job->tmp holds the scratch */
+int lists_sort_tmp(ListsSortPtr job)
 {
-	unsigned long index = list->ptr - list->start;
-	void **ptr;
+	unsigned long samples, i, total;
+	int t, b;
 
-	if(size == index)
+	if(job->threads < 2 || job->size < LISTS_SORT_MIN) {
+		lists_sort_range(job, job->start, job->tmp, job->size);
 		return(TRUE);
+	}
 
-	if(size < index)
-		return(VoidListRemove(list, size, index - size));
+	samples = job->threads * LISTS_SORT_SAMPLES;
+	job->count = lists_calloc(job->threads * job->threads, sizeof(unsigned long));
+	job->splitter = lists_malloc((samples * 2 + job->threads) * job->width);
+	if(!job->count || !job->splitter) {
+		lists_free(job->count);
+		lists_free(job->splitter);
+		return(FALSE);
+	}
 
-	VoidListReserve(list, size, 0, 0);
-	ptr = list->start + size;
-	while(list->ptr < ptr)
-		list->alloc_func(list, list->ptr++, value, width ? width : list->width);
+	/* Evenly spaced samples, sorted, give threads - 1 splitters */
+	for(i = 0; i < samples; i++)
+		memcpy(job->splitter + i * job->width, job->start + job->size / samples * i * job->width, job->width);
+	lists_sort_range(job, job->splitter, job->splitter + samples * job->width, samples);
+	for(t = 1; t < job->threads; t++)
+		memcpy(job->splitter + (t - 1) * job->width, job->splitter + samples / job->threads * t * job->width, job->width);
+
+	lists_parallel(job, lists_sort_count);
+
+	/* Turn counts into scatter offsets: bucket-major, then thread order within a bucket */
+	for(b = 0, total = 0; b < job->threads; b++)
+		for(t = 0; t < job->threads; t++) {
+			i = job->count[t * job->threads + b];
+			job->count[t * job->threads + b] = total;
+			total += i;
+		}
+
+	lists_parallel(job, lists_sort_scatter);
+	lists_parallel(job, lists_sort_bucket_sort);
+
+	lists_free(job->count);
+	lists_free(job->splitter);
 
 	return(TRUE);
 }
 
-void *VoidListPush(VoidListPtr list, void *value, size_t width)
+/* Bytes of scratch lists_sort_tmp needs: none for single threaded longs, which qsort sorts in place */
+size_t lists_sort_scratch(ListsSortPtr job)
 {
-	if(list->ptr >= list->start + list->reserve)
-		if(!VoidListReserve(list, list->reserve, 0, 0))
-			return NULL;
+	if(!job->list && (job->threads < 2 || job->size < LISTS_SORT_MIN))
+		return(0);
 
-	list->alloc_func(list, list->ptr, value, width ? width : list->width);
-	return *list->ptr++;
+	return(job->size * job->width);
 }
 
-void *VoidListPop(VoidListPtr list, void *value, size_t width)
+int lists_sort(ListsSortPtr job)
 {
-	unsigned long size;
-
-	if(list->ptr <= list->start)
-		return NULL;
-
-	list->ptr--;
-
-	if(value)
-		list->cpy_func(list, value, *list->ptr, width ? width : list->width);
+	int result;
 
-	list->free_func(list, *list->ptr);
+	if((job->tmp = lists_malloc(lists_sort_scratch(job) + 1)) == NULL)
+		return(FALSE);
 
-	if(list->reserve - (list->grow << 1) >= (size = list->ptr - list->start))
-		VoidListReserve(list, size, 0, 0);
+	result = lists_sort_tmp(job);
+	lists_free(job->tmp);
 
-	return value;
+	return(result);
 }
 
-void **VoidListPointer(VoidListPtr list, long index)
+/* Moves each duplicate of its predecessor to the back of the thread's chunk */
+void lists_unique_chunk(ListsSortPtr job, int thread)
 {
-	void **ptr = (index < 0 ? list->ptr : list->start) + index;
-
-	if(ptr < list->start || ptr >= list->ptr)
-		return(NULL);
+	char *start = job->start + job->size * thread / job->threads * job->width,
+			*end = job->start + job->size * (thread + 1) / job->threads * job->width,
+			*prev = job->prev + thread * job->width * 2, *value = prev + job->width,
+			*ptr, *keep = start;
+	int first = !thread;
+
+	for(ptr = start; ptr < end; ptr += job->width) {
+		memcpy(value, ptr, job->width);
+		if(first || job->cmp_func(job, prev, value)) {
+			memcpy(ptr, keep, job->width);
+			memcpy(keep, value, job->width);
+			keep += job->width;
+		}
+		memcpy(prev, value, job->width);
+		first = FALSE;
+	}
 
-	return(ptr);
+	job->kept[thread] = (keep - start) / job->width;
 }
 
-int VoidListSet(VoidListPtr list, long index, void *value, size_t width)
+/* Drops adjacent duplicates of a sorted array; dropped Void elements are released in order */
+int lists_unique(ListsSortPtr job)
 {
-	void **ptr;
+	unsigned long first, last, size = 0;
+	int t;
 
-	if(!(ptr = VoidListPointer(list, index)))
+	if(job->size < LISTS_SORT_MIN)
+		job->threads = 1;
+
+	job->kept = lists_malloc(job->threads * sizeof(unsigned long));
+	job->prev = lists_malloc(job->threads * job->width * 2);
+	if(!job->kept || !job->prev) {
+		lists_free(job->kept);
+		lists_free(job->prev);
 		return(FALSE);
+	}
 
-	list->free_func(list, *ptr);
-	list->alloc_func(list, ptr, value, width ? width : list->width);
+	/* Each chunk compares its first element with the last of the chunk before */
+	for(t = 1; t < job->threads; t++)
+		memcpy(job->prev + t * job->width * 2, job->start + (job->size * t / job->threads - 1) * job->width, job->width);
 
-	return(TRUE);
-}
+	lists_parallel(job, lists_unique_chunk);
 
-int VoidListGet(VoidListPtr list, long index, void *value, size_t width)
-{
-	void **ptr;
+	for(t = 0; t < job->threads; t++) {
+		first = job->size * t / job->threads;
+		last = job->size * (t + 1) / job->threads;
 
-	if(!(ptr = VoidListPointer(list, index)))
-		return(FALSE);
+		if(job->list)
+			voidlist_free_block(job->list, (void **)job->start + first + job->kept[t], last - first - job->kept[t]);
 
-	if(value)
-		list->cpy_func(list, value, *ptr, width ? width : list->width);
+		memmove(job->start + size * job->width, job->start + first * job->width, job->kept[t] * job->width);
+		size += job->kept[t];
+	}
+	job->size = size;
+
+	lists_free(job->kept);
+	lists_free(job->prev);
 
 	return(TRUE);
 }
 
-long VoidListFind(VoidListPtr list, void *value, size_t width)
-{
-	void **ptr = list->ptr;
 
-	while(--ptr >= list->start)
-		if(list->cmp_func(list, *ptr, value, width ? width : list->width))
-			return(ptr - list->start);
+/***************************
+ *  List text functions
+ */
+#define LISTS_WRITE_BUFFER	65536	/* bytes staged before each write */
+#define LISTS_WRITE_DIRECT	4096	/* longer strings skip the staging buffer */
+
+/* Buffered output to either a FILE or a file descriptor */
+typedef struct {
+	FILE *stream;
+	int fd;
+	int error;
+	size_t used;
+	char buffer[LISTS_WRITE_BUFFER];
+} ListsWriterType;
+typedef ListsWriterType *ListsWriterPtr;
+
+static const char lists_digits[] =
+	"00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+	"40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+	"8081828384858687888990919293949596979899";
+
+/* Writes value in decimal two digits at a time, returns the length; out needs 20 bytes */
+size_t lists_itoa(char *out, long value)
+{
+	char tmp[20], *ptr = tmp + sizeof(tmp);
+	unsigned long v = value < 0 ? -(unsigned long)value : (unsigned long)value;
+	size_t length;
+
+	while(v >= 100) {
+		ptr -= 2;
+		memcpy(ptr, lists_digits + (v % 100) * 2, 2);
+		v /= 100;
+	}
 
-	return(-1);
-}
+	if(v >= 10) {
+		ptr -= 2;
+		memcpy(ptr, lists_digits + v * 2, 2);
+	} else
+		*--ptr = '0' + v;
 
-int VoidListReverse(VoidListPtr list, long index, unsigned long size)
-{
-	void *tmp, **ptr[2];
-	unsigned long list_size = list->ptr - list->start;
+	if(value < 0)
+		*--ptr = '-';
 
-	if(!list_size || index + size > list_size)
-		return(FALSE);
+	length = tmp + sizeof(tmp) - ptr;
+	memcpy(out, ptr, length);
 
-	if(!size)
-		size = list_size - index;
+	return(length);
+}
 
-	if(size < 2)
-		return(TRUE);
+#ifdef LISTS_WRITEV
+/* Writes all of iov, picking up after short writes */
+int lists_writev(int fd, struct iovec *iov, int count)
+{
+	ssize_t done;
 
-	if(!(ptr[0] = VoidListPointer(list, index)))
-		return(FALSE);
+	while(count) {
+		if((done = writev(fd, iov, count)) < 0)
+			return(FALSE);
 
-	ptr[1] = ptr[0] + size - 1;
+		for(; count && (size_t)done >= iov->iov_len; iov++, count--)
+			done -= iov->iov_len;
 
-	while(ptr[0] < ptr[1]) {
-		memcpy(&tmp, ptr[1], sizeof(void *));
-		memcpy(ptr[1], ptr[0], sizeof(void *));
-		memcpy(ptr[0], &tmp, sizeof(void *));
-		ptr[0]++, ptr[1]--;
+		if(count) {
+			iov->iov_base = (char *)iov->iov_base + done;
+			iov->iov_len -= done;
+		}
 	}
 
 	return(TRUE);
 }
-
-int VoidListRotate(VoidListPtr list, long amount, long index, unsigned long size)
+#else
+/* Writes all of data with plain writes, picking up after short ones */
+int lists_write(int fd, const char *data, size_t length)
 {
-	void **tmp, **ptr[2];
-	unsigned long list_size = list->ptr - list->start;
-
-	if(!list_size || index + size > list_size)
-		return(FALSE);
+	long done;
 
-	if(!size)
-		size = list_size - index;
+	while(length) {
+		if((done = write(fd, data, length)) < 0)
+			return(FALSE);
 
-	if(size < 2)
-		return(TRUE);
+		data += done;
+		length -= done;
+	}
 
-	if(!(ptr[0] = VoidListPointer(list, index)))
-		return(FALSE);
+	return(TRUE);
+}
+#endif
 
-	ptr[1] = ptr[0] + size;
+/* Flushes the staged bytes, followed by extra bytes (if any) in the same call where the system allows */
+int lists_writer_flush(ListsWriterPtr writer, const char *extra, size_t length)
+{
+#ifdef LISTS_WRITEV
+	struct iovec iov[2];
+#endif
 
-	if((tmp = malloc(labs(amount) * sizeof(void *))) == NULL)
+	if(writer->error)
 		return(FALSE);
 
-	if(amount > 0) {
-		memcpy(tmp, ptr[1] - amount, sizeof(void *) * amount);
-		memmove(ptr[0] + amount, ptr[0], sizeof(void *) * (size - amount));
-		memcpy(ptr[0], tmp, sizeof(void *) * amount);
+	if(writer->stream) {
+		if((writer->used && fwrite(writer->buffer, 1, writer->used, writer->stream) != writer->used)
+				|| (length && fwrite(extra, 1, length, writer->stream) != length))
+			writer->error = TRUE;
 	} else {
-		amount = -amount;
-		memcpy(tmp, ptr[0], sizeof(void *) * amount);
-		memmove(ptr[0], ptr[0] + amount, sizeof(void *) * (size - amount));
-		memcpy(ptr[1] - amount, tmp, sizeof(void *) * amount);
+#ifdef LISTS_WRITEV
+		iov[0].iov_base = writer->buffer;
+		iov[0].iov_len = writer->used;
+		iov[1].iov_base = (char *)extra;
+		iov[1].iov_len = length;
+		if(!lists_writev(writer->fd, iov, length ? 2 : 1))
+			writer->error = TRUE;
+#else
+		if(!lists_write(writer->fd, writer->buffer, writer->used) || !lists_write(writer->fd, extra, length))
+			writer->error = TRUE;
+#endif
 	}
 
-	free(tmp);
+	writer->used = 0;
 
-	return(TRUE);
+	return(!writer->error);
 }
 
-int VoidListCopy(VoidListPtr dest, VoidListPtr src, long index, unsigned long size)
+void lists_writer_put(ListsWriterPtr writer, const char *data, size_t length)
 {
-	void **ptr;
-	unsigned long dest_size = dest->ptr - dest->start,
-			src_size = src->ptr - src->start;
+	if(length >= LISTS_WRITE_DIRECT) {
+		lists_writer_flush(writer, data, length);
+		return;
+	}
 
-	if(index + size > src_size)
-		return(FALSE);
+	if(writer->used + length > LISTS_WRITE_BUFFER)
+		lists_writer_flush(writer, NULL, 0);
 
-	if(!(ptr = VoidListPointer(src, index)))
-		return(FALSE);
+	memcpy(writer->buffer + writer->used, data, length);
+	writer->used += length;
+}
 
-	if(!size)
-		size = src_size - index;
+/* Eight ASCII digits at once; the first digit sits in the lowest byte */
+int lists_digits8(const char *ptr, unsigned long *value)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	uint64_t x;
 
-	if(!VoidListReserve(dest, dest_size + size, src->grow, 0))
+	memcpy(&x, ptr, 8);
+
+	if((x & 0xF0F0F0F0F0F0F0F0ULL) != 0x3030303030303030ULL
+			|| ((x + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) != 0x3030303030303030ULL)
 		return(FALSE);
 
-	while(size--)
-		dest->alloc_func(dest, dest->ptr++, *ptr++, src->width);
+	x -= 0x3030303030303030ULL;
+	x = x * 10 + (x >> 8);
+	x = ((x & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))
+			+ ((x >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32))) >> 32;
+	*value = x;
 
 	return(TRUE);
+#else
+	return(FALSE);
+#endif
 }
 
-int VoidListMove(VoidListPtr dest, VoidListPtr src, long index, unsigned long size)
+/***************************
+ *  Integer List functions
+ */
+long intlist_load(size_t width, void *ptr)
 {
-	if(!(VoidListCopy(dest, src, index, size)))
-		return(FALSE);
-
-	if(!VoidListResize(src, 0, NULL, 0))
-		return(FALSE);
+	switch(width) {
+	case 1:
+		return(*(int8_t *)ptr);
+	case 2:
+		return(*(int16_t *)ptr);
+	case 4:
+		return(*(int32_t *)ptr);
+	}
 
-	return(TRUE);
+	return(*(long *)ptr);
 }
 
-/* Void List mapping functions */
-int VoidListMap(VoidListPtr list, VoidListMapFunc map_func, void *custom)
+void intlist_store(size_t width, void *ptr, long value)
 {
-	void **ptr = list->start;
-	long index = 0;
-
-	while(ptr < list->ptr) {
-		*ptr = map_func(list, index++, *ptr, custom);
-		ptr++;
+	switch(width) {
+	case 1:
+		*(int8_t *)ptr = (int8_t)value;
+		break;
+	case 2:
+		*(int16_t *)ptr = (int16_t)value;
+		break;
+	case 4:
+		*(int32_t *)ptr = (int32_t)value;
+		break;
+	default:
+		*(long *)ptr = value;
 	}
-
-	return(TRUE);
 }
 
-int VoidListFilter(VoidListPtr list, VoidListFilterFunc filter_func, void *custom)
+/* Narrowest lane that holds value without loss */
+size_t intlist_width(long value)
 {
-	void **ptr = list->ptr;
-	long n;
+	if(value == (int8_t)value)
+		return(1);
 
-	while(--ptr >= list->start)
-		if(!filter_func(list, *ptr, custom)) {
-			list->free_func(list, *ptr);
+	if(value == (int16_t)value)
+		return(2);
 
-			if((n = --list->ptr - ptr))
-				memmove(ptr, ptr + 1, n * sizeof(long));
-		}
+	if(value == (int32_t)value)
+		return(4);
 
-	return(TRUE);
+	return(sizeof(long));
 }
 
-int VoidListReduce(VoidListPtr list, VoidListReduceFunc reduce_func, void **value, void *initial, void *custom)
+/* Lane widths are powers of two: 1, 2, 4, 8 -> 0, 1, 2, 3 */
+size_t intlist_shift(size_t width)
 {
-	void **ptr = list->ptr;
-	long size = ptr - list->start;
-
-	while(size--)
-		initial = reduce_func(list, initial, *--ptr, custom);
-
-	if(value)
-		*value = initial;
+	return((width >> 1) - (width >> 3));
+}
 
-	return(TRUE);
+char *intlist_at(IntListPtr list, unsigned long index)
+{
+	return((char *)list->start + index * list->width);
 }
 
+unsigned long intlist_size(IntListPtr list)
+{
+	return(((char *)list->ptr - (char *)list->start) >> list->shift);
+}
+
+/* Stores value at index, widening the list first if it no longer fits */
+int intlist_put(IntListPtr list, unsigned long index, long value)
+{
+	if(list->width < sizeof(long) && intlist_width(value) > list->width)
+		if(!IntListWiden(list, intlist_width(value)))
+			return(FALSE);
 
+	intlist_store(list->width, intlist_at(list, index), value);
 
-/* Void List callback functions */
-int voidlist_alloc(VoidListPtr list, void **ptr, void *value, size_t width)
+	return(TRUE);
+}
+
+/* Full-width view of the elements: the buffer itself, or a widened copy in *tmp */
+long *intlist_longs(IntListPtr list, long **tmp)
 {
-	//*ptr = malloc(width);
-	*ptr = calloc(1, width);
+	static long empty;
+	unsigned long i, size = intlist_size(list);
 
-	if(value)
-		list->cpy_func(list, *ptr, value, width);
+	*tmp = NULL;
+
+	/* A never-grown list has no buffer, which must not read as out of memory */
+	if(list->width == sizeof(long))
+		return(list->start ? list->start : &empty);
+
+	if((*tmp = lists_malloc((size ? size : 1) * sizeof(long))) == NULL)
+		return(NULL);
+
+	for(i = 0; i < size; i++)
+		(*tmp)[i] = intlist_load(list->width, intlist_at(list, i));
+
+	return(*tmp);
+}
+
+int IntListInit(IntListPtr list, long reserve, long grow)
+{
+	return(IntListInitWidth(list, reserve, grow, sizeof(long)));
+}
+
+int IntListInitWidth(IntListPtr list, long reserve, long grow, size_t width)
+{
+	list->start = list->ptr = NULL;
+	list->reserve = list->grow = 0;
+	list->budget = 0;
+
+	if(width != 1 && width != 2 && width != 4 && width != sizeof(long))
+		return(FALSE);
+
+	list->width = width;
+	list->shift = intlist_shift(width);
+
+	if(reserve && (list->start = list->ptr = lists_buffer_realloc(NULL, reserve * width)) == NULL)
+		return(FALSE);
+
+	list->reserve = reserve;
+	list->grow = grow;
 
 	return(TRUE);
 }
 
-void voidlist_free(VoidListPtr list, void *ptr)
+void IntListFree(IntListPtr list)
 {
-	free(ptr);
+	if(lists_register_count)
+		ListsUnregister(list);
+
+	if(list->start)
+	{
+		lists_buffer_free(list->start);
+		list->start = NULL;
+	}
+
+	list->ptr = NULL;
+	list->reserve = 0;
+	list->grow = 0;
+	list->budget = 0;
 }
 
-void voidlist_cpy(VoidListPtr list, void *dest, void *src, size_t width)
+void IntListDump(IntListPtr list, FILE *stream, int type)
 {
-	memcpy(dest, src, width);
+	if(type) {
+		fprintf(stream, "Integer List [0x%p]\n", list);
+		fprintf(stream, " |--Start: 0x%p\n", list->start);
+		fprintf(stream, " |--Pointer: 0x%p(+%lu)\n", list->ptr, intlist_size(list));
+		fprintf(stream, " |--Reserve: %lu\n", list->reserve);
+		fprintf(stream, " |--Grow: +%lu\n", list->grow);
+		fprintf(stream, " +--Width: %zu bytes\n\n", list->width);
+	} else
+		fprintf(stream, "Integer List [0x%p] Data: [0x%p:+%lu], Reserve [%lu:+%lu], Width [%zu b.]\n",
+				list, list->start, intlist_size(list),
+				list->reserve, list->grow, list->width);
 }
 
-int voidlist_cmp(VoidListPtr list, void *ptr1, void *ptr2, size_t width)
+long intlist_print(IntListPtr list, long index, long value, void *custom)
 {
-	return(memcmp(ptr1, ptr2, width));
+	fprintf(custom, "%ld ", value);
+	return(value);
 }
 
+int intlist_write(IntListPtr list, ListsWriterPtr writer, char delimiter)
+{
+	char *ptr = list->start, *end = list->ptr;
 
-/**************************
- *  String List Functions
- */
-int StrListInit(StrListPtr list, long reserve, long grow)
+	for(; ptr < end; ptr += list->width) {
+		if(writer->used + 21 > LISTS_WRITE_BUFFER)
+			lists_writer_flush(writer, NULL, 0);
+		writer->used += lists_itoa(writer->buffer + writer->used, intlist_load(list->width, ptr));
+		writer->buffer[writer->used++] = delimiter;
+	}
+
+	return(lists_writer_flush(writer, NULL, 0));
+}
+
+/* Writes each element in decimal followed by delimiter */
+int IntListWrite(IntListPtr list, FILE *stream, char delimiter)
 {
-	return(VoidListInit(list, reserve, grow, 0, strlist_alloc, voidlist_free, strlist_cpy, strlist_cmp));
+	ListsWriterType writer;
+
+	writer.stream = stream;
+	writer.error = FALSE;
+	writer.used = 0;
+
+	return(intlist_write(list, &writer, delimiter));
 }
 
-void StrListDump(StrListPtr list, FILE *stream, int type)
+int IntListWriteFd(IntListPtr list, int fd, char delimiter)
 {
-	_VoidListDump(list, stream, type, "String List");
+	ListsWriterType writer;
+
+	writer.stream = NULL;
+	writer.fd = fd;
+	writer.error = FALSE;
+	writer.used = 0;
+
+	return(intlist_write(list, &writer, delimiter));
 }
 
-int StrListReserve(VoidListPtr list, unsigned long size, unsigned long grow)
+/* Appends every decimal number in buffer; anything but digits and a leading '-' separates them */
+int IntListParse(IntListPtr list, const char *buffer, size_t length)
 {
-	return(VoidListReserve(list, size, grow, 0));
+	const char *ptr = buffer, *end = buffer + length;
+	unsigned long value, chunk;
+	int negative, digits;
+
+	while(ptr < end) {
+		if(*ptr == '-' && ptr + 1 < end && (unsigned)(ptr[1] - '0') < 10) {
+			negative = TRUE;
+			ptr++;
+		} else if((unsigned)(*ptr - '0') < 10)
+			negative = FALSE;
+		else {
+			ptr++;
+			continue;
+		}
+
+		while(ptr + 1 < end && *ptr == '0' && (unsigned)(ptr[1] - '0') < 10)
+			ptr++;
+
+		for(value = 0, digits = 0; ptr + 8 <= end && lists_digits8(ptr, &chunk); ptr += 8, digits += 8) {
+			if(digits > 11)
+				return(FALSE);
+			value = value * 100000000 + chunk;
+		}
+
+		for(; ptr < end && (unsigned)(*ptr - '0') < 10; ptr++, digits++) {
+			if(digits > 18)
+				return(FALSE);
+			value = value * 10 + (*ptr - '0');
+		}
+
+		if(value > (unsigned long)LONG_MAX + negative)
+			return(FALSE);
+
+		if(!IntListPush(list, negative ? (long)-value : (long)value))
+			return(FALSE);
+	}
+
+	return(TRUE);
 }
 
-int StrListResize(StrListPtr list, unsigned long size, char *value)
+void IntListPrint(IntListPtr list, FILE *stream, IntListMapFunc func)
 {
-	return(VoidListResize(list, size, value, 0));
+	fprintf(stream, "[ ");
+	if(func)
+		IntListMap(list, func, stream);
+	else
+		IntListWrite(list, stream, ' ');
+	fprintf(stream, "]\n");
 }
-char *StrListPush(StrListPtr list, char *value)
+
+int intlist_reserve(IntListPtr list, unsigned long size, unsigned long grow)
 {
-	return (char *)VoidListPush(list, value, 0);
+	unsigned long index = intlist_size(list), limit, wanted;
+	void *ptr;
+
+	if(!size)
+		size = index;
+
+	if(grow)
+		list->grow = grow;
+
+	if(size < index)
+		size = index;
+
+	wanted = size;
+	size = (size / list->grow + 1) * list->grow;
+
+	if(size < list->grow)
+		size = list->grow;
+
+	/* Fixed buffers can round up only as far as their reservation, budgeted ones to their budget */
+	if(size > (limit = lists_buffer_limit(list->start) / list->width))
+		size = limit;
+
+	if(list->budget && size > (limit = list->budget / list->width))
+		size = limit;
+
+	if(size < wanted)
+		return(FALSE);
+
+	if((ptr = lists_buffer_realloc(list->start, size * list->width)) == NULL)
+		return(FALSE);
+
+	list->start = ptr;
+	list->ptr = (char *)ptr + index * list->width;
+	list->reserve = size;
+
+	return(TRUE);
 }
 
-char *StrListPop(StrListPtr list, char *value)
+int IntListReserve(IntListPtr list, unsigned long size, unsigned long grow)
 {
-	return (char *)VoidListPop(list, value, 0);
+	unsigned long start = lists_trace_start(), before = list->reserve * list->width;
+	int result = intlist_reserve(list, size, grow);
+
+	LISTS_PROBE3(reserve, list, before, list->reserve * list->width);
+	lists_trace_stop(LISTS_OP_RESERVE, start);
+
+	return(result);
 }
 
-int StrListSet(StrListPtr list, long index, char *value)
+int IntListWiden(IntListPtr list, size_t width)
 {
-	return(VoidListSet(list, index, value, 0));
+	unsigned long size = intlist_size(list);
+	size_t old = list->width;
+	char *ptr = list->start;
+
+	if(width != 1 && width != 2 && width != 4 && width != sizeof(long))
+		return(FALSE);
+
+	if(width <= old)
+		return(TRUE);
+
+	if(list->budget && list->reserve * width > list->budget)
+		return(FALSE);
+
+	if(list->reserve && (ptr = lists_buffer_realloc(list->start, list->reserve * width)) == NULL)
+		return(FALSE);
+
+	/* Lanes only grow, so convert back to front in place */
+	list->start = ptr;
+	list->width = width;
+	list->shift = intlist_shift(width);
+	list->ptr = ptr + size * width;
+	while(size--)
+		intlist_store(width, ptr + size * width, intlist_load(old, ptr + size * old));
+
+	return(TRUE);
 }
 
-int StrListGet(StrListPtr list, long index, char *value)
+/* Pins the buffer in a reservation of size elements so pointers survive growth */
+int IntListReserveAddress(IntListPtr list, unsigned long size)
 {
-	return(VoidListGet(list, index, value, 0));
+#ifdef LISTS_MMAP
+	unsigned long index;
+	void *ptr;
+
+	if(!IntListWiden(list, sizeof(long)))
+		return(FALSE);
+
+	if((index = intlist_size(list)) > size)
+		return(FALSE);
+
+	if((ptr = lists_buffer_reserve(list->start, size * list->width)) == NULL)
+		return(FALSE);
+
+	list->start = ptr;
+	list->ptr = (char *)ptr + index * list->width;
+
+	return(TRUE);
+#else
+	return(FALSE);
+#endif
 }
 
-long StrListFind(StrListPtr list, char *value)
+int IntListSetBudget(IntListPtr list, size_t bytes)
 {
-	/* Note: this will bash current compare function */
-	list->cmp_func = strlist_cmp;
-	return(VoidListFind(list, value, 0));
+	list->budget = bytes;
+
+	return(!bytes || list->reserve * list->width <= bytes);
 }
 
-long StrListFindCase(StrListPtr list, char *value)
+size_t IntListBytes(IntListPtr list)
 {
-	/* Note: this will bash current compare function */
-	list->cmp_func = strlist_icmp;
-	return(VoidListFind(list, value, 0));
+	return(list->start ? lists_block(list->start)->size : 0);
 }
 
-/* String mapping functions */
-int StrListMap(StrListPtr list, StrListMapFunc map_func, void *custom)
+/* Drops the grow slack, leaving room for exactly the current elements */
+int IntListTrim(IntListPtr list)
 {
-	return(VoidListMap(list, *((VoidListMapFunc *)&map_func), custom));
+	unsigned long index = intlist_size(list);
+	void *ptr;
+
+	if(!list->start || (unsigned long)list->reserve == index)
+		return(TRUE);
+
+	if((ptr = lists_buffer_realloc(list->start, index * list->width)) == NULL)
+		return(FALSE);
+
+	list->start = ptr;
+	list->ptr = (char *)ptr + index * list->width;
+	list->reserve = index;
+
+	return(TRUE);
 }
 
-int StrListFilter(StrListPtr list, StrListFilterFunc filter_func, void *custom)
+int IntListRegister(IntListPtr list)
 {
-	return(VoidListFilter(list, *((VoidListFilterFunc *)&filter_func), custom));
+	return(lists_register(list, LISTS_REGISTER_INT));
 }
 
-int StrListReduce(StrListPtr list, StrListReduceFunc reduce_func, void **value, void *initial, void *custom)
+long IntListSize(IntListPtr list)
 {
-	return(VoidListReduce(list, *((VoidListReduceFunc *)&reduce_func), value, initial, custom));
+	return(intlist_size(list));
 }
 
-void StrListPrint(VoidListPtr list, FILE *stream, VoidListMapFunc func)
+int intlist_remove(IntListPtr list, long index, unsigned long size)
 {
-	VoidListPrint(list, stream, func ? func : strlist_print);
+	char *dest = intlist_at(list, index), *src = dest + size * list->width;
+
+	if(!size || src > (char *)list->ptr)
+		return(FALSE);
+
+	if(src < (char *)list->ptr)
+		memmove(dest, src, (char *)list->ptr - src);
+
+	list->ptr = (char *)list->ptr - size * list->width;
+
+	IntListReserve(list, 0, 0);
+
+	return(TRUE);
 }
 
-/* String List callback functions */
-int strlist_alloc(VoidListPtr list, void **ptr, void *value, size_t width)
+int IntListRemove(IntListPtr list, long index, unsigned long size)
 {
-	return(voidlist_alloc(list, ptr, value, strlen(value) + 1));
+	unsigned long start = lists_trace_start(), moved = intlist_size(list) - index - size;
+	int result = intlist_remove(list, index, size);
+
+	LISTS_PROBE4(remove, list, index, size, result ? moved * list->width : 0);
+	lists_trace_stop(LISTS_OP_REMOVE, start);
+
+	return(result);
 }
 
-void strlist_cpy(VoidListPtr list, void *dest, void *src, size_t width)
+int IntListResize(IntListPtr list, unsigned long size, long value)
 {
-	strcpy(dest, src);
+	unsigned long index = intlist_size(list);
+	char *ptr;
+
+	if(size == index)
+		return(TRUE);
+
+	if(size < index)
+		return(IntListRemove(list, size, index - size));
+
+	if(!IntListReserve(list, size, 0))
+		return(FALSE);
+
+	if(list->width < sizeof(long) && !IntListWiden(list, intlist_width(value)))
+		return(FALSE);
+
+	ptr = intlist_at(list, size);
+	while((char *)list->ptr < ptr) {
+		intlist_store(list->width, list->ptr, value);
+		list->ptr = (char *)list->ptr + list->width;
+	}
+
+	return(TRUE);
 }
 
-int strlist_cmp(VoidListPtr list, void *ptr1, void *ptr2, size_t width)
+/* Like IntListResize, but new elements are left for the caller to set */
+int IntListResizeUninit(IntListPtr list, unsigned long size)
 {
-	return(strcmp(ptr1, ptr2));
+	unsigned long index = intlist_size(list);
+
+	if(size == index)
+		return(TRUE);
+
+	if(size < index)
+		return(IntListRemove(list, size, index - size));
+
+	if(!IntListReserve(list, size, 0))
+		return(FALSE);
+
+	list->ptr = intlist_at(list, size);
+
+	return(TRUE);
 }
 
-int strlist_icmp(VoidListPtr list, void *ptr1, void *ptr2, size_t width)
+/* Adds count uninitialised elements, widening to long lanes, and returns the first */
+long *IntListAppendSpace(IntListPtr list, unsigned long count)
 {
-	return(strcasecmp(ptr1, ptr2));
+	unsigned long index = intlist_size(list);
+
+	if(!IntListWiden(list, sizeof(long)))
+		return(NULL);
+
+	if(index + count > (unsigned long)list->reserve && !IntListReserve(list, index + count, 0))
+		return(NULL);
+
+	list->ptr = (long *)list->ptr + count;
+
+	return((long *)list->start + index);
 }
 
-void *strlist_print(VoidListPtr list, long index, void *value, void *custom)
+int IntListPush(IntListPtr list, long value)
 {
-	fprintf(custom, "%s ", (char *)value);
-	return(value);
+	if((char *)list->ptr >= (char *)list->start + (list->reserve << list->shift))
+		if(!IntListReserve(list, 0, 0) || (char *)list->ptr >= (char *)list->start + (list->reserve << list->shift))
+			return(FALSE);
+
+	if(list->width < sizeof(long) && intlist_width(value) > list->width)
+		if(!IntListWiden(list, intlist_width(value)))
+			return(FALSE);
+
+	intlist_store(list->width, list->ptr, value);
+	list->ptr = (char *)list->ptr + list->width;
+
+	return(TRUE);
 }
 
+int IntListPop(IntListPtr list, long *value)
+{
+	unsigned long size;
+
+	if(list->ptr <= list->start)
+		return(FALSE);
+
+	list->ptr = (char *)list->ptr - list->width;
+
+	if(value)
+		*value = intlist_load(list->width, list->ptr);
+
+	if(list->reserve - (list->grow << 1) >= (size = intlist_size(list)))
+		IntListReserve(list, size, 0);
+
+	return(TRUE);
+}
+
+/* Resolves a (possibly negative) index to an element address, or NULL */
+char *intlist_index(IntListPtr list, long index)
+{
+	char *ptr = (char *)(index < 0 ? list->ptr : list->start) + index * (long)list->width;
+
+	if(ptr < (char *)list->start || ptr >= (char *)list->ptr)
+		return(NULL);
+
+	return(ptr);
+}
+
+long *IntListPointer(IntListPtr list, long index)
+{
+	/* Narrow lanes can't be handed out as long pointers */
+	if(list->width != sizeof(long))
+		return(NULL);
+
+	return((long *)intlist_index(list, index));
+}
+
+int IntListSet(IntListPtr list, long index, long value)
+{
+	char *ptr;
+
+	if(!(ptr = intlist_index(list, index)))
+		return(FALSE);
+
+	return(intlist_put(list, (ptr - (char *)list->start) >> list->shift, value));
+}
+
+int IntListGet(IntListPtr list, long index, long *value)
+{
+	char *ptr;
+
+	if(!(ptr = intlist_index(list, index)))
+		return(FALSE);
+
+	if(value)
+		*value = intlist_load(list->width, ptr);
+
+	return(TRUE);
+}
+
+long IntListFind(IntListPtr list, long value)
+{
+	long n = intlist_size(list);
+
+	/* A value wider than the lanes can't be stored here */
+	if(intlist_width(value) > list->width)
+		return(-1);
+
+	switch(list->width) {
+	case 1:
+		while(--n >= 0)
+			if(((int8_t *)list->start)[n] == value)
+				return(n);
+		break;
+	case 2:
+		while(--n >= 0)
+			if(((int16_t *)list->start)[n] == value)
+				return(n);
+		break;
+	case 4:
+		while(--n >= 0)
+			if(((int32_t *)list->start)[n] == value)
+				return(n);
+		break;
+	default:
+		while(--n >= 0)
+			if(((long *)list->start)[n] == value)
+				return(n);
+	}
+
+	return(-1);
+}
+
+int IntListReverse(IntListPtr list, long index, unsigned long size)
+{
+	long tmp;
+	char *ptr[2];
+	unsigned long list_size = intlist_size(list);
+
+	if(!list_size || index + size > list_size)
+		return(FALSE);
+
+	if(!size)
+		size = list_size - index;
+
+	if(size < 2)
+		return(TRUE);
+
+	if(!(ptr[0] = intlist_index(list, index)))
+		return(FALSE);
+
+	ptr[1] = ptr[0] + (size - 1) * list->width;
+
+	while(ptr[0] < ptr[1]) {
+		memcpy(&tmp, ptr[1], list->width);
+		memcpy(ptr[1], ptr[0], list->width);
+		memcpy(ptr[0], &tmp, list->width);
+		ptr[0] += list->width, ptr[1] -= list->width;
+	}
+
+	return(TRUE);
+}
+
+int intlist_rotate(IntListPtr list, long amount, long index, unsigned long size)
+{
+	char *tmp, *ptr[2];
+	unsigned long list_size = intlist_size(list);
+	size_t width = list->width;
+
+	if(!list_size || index + size > list_size)
+		return(FALSE);
+
+	if(!size)
+		size = list_size - index;
+
+	if(size < 2)
+		return(TRUE);
+
+	if(!(ptr[0] = intlist_index(list, index)))
+		return(FALSE);
+
+	ptr[1] = ptr[0] + size * width;
+
+	if((tmp = lists_malloc(labs(amount) * width)) == NULL)
+		return(FALSE);
+
+	if(amount > 0) {
+		memcpy(tmp, ptr[1] - amount * width, width * amount);
+		memmove(ptr[0] + amount * width, ptr[0], width * (size - amount));
+		memcpy(ptr[0], tmp, width * amount);
+	} else {
+		amount = -amount;
+		memcpy(tmp, ptr[0], width * amount);
+		memmove(ptr[0], ptr[0] + amount * width, width * (size - amount));
+		memcpy(ptr[1] - amount * width, tmp, width * amount);
+	}
+
+	lists_free(tmp);
+
+	return(TRUE);
+}
+
+int IntListRotate(IntListPtr list, long amount, long index, unsigned long size)
+{
+	unsigned long start = lists_trace_start();
+	int result = intlist_rotate(list, amount, index, size);
+
+	LISTS_PROBE4(rotate, list, amount, index, (size ? size : intlist_size(list) - index) * list->width);
+	lists_trace_stop(LISTS_OP_ROTATE, start);
+
+	return(result);
+}
+
+int intlist_copy(IntListPtr dest, IntListPtr src, long index, unsigned long size)
+{
+	char *ptr;
+	unsigned long dest_size = intlist_size(dest),
+			src_size = intlist_size(src);
+
+	if(index + size > src_size)
+		return(FALSE);
+
+	if(!(ptr = intlist_index(src, index)))
+		return(FALSE);
+
+	if(!size)
+		size = src_size - index;
+
+	if(!IntListWiden(dest, src->width))
+		return(FALSE);
+
+	if(!IntListReserve(dest, dest_size + size, src->grow))
+		return(FALSE);
+
+	/* Reserving may have moved src if it is also dest */
+	ptr = intlist_index(src, index);
+
+	if(dest->width == src->width) {
+		memmove(dest->ptr, ptr, src->width * size);
+		dest->ptr = (char *)dest->ptr + src->width * size;
+	} else
+		while(size--) {
+			intlist_store(dest->width, dest->ptr, intlist_load(src->width, ptr));
+			dest->ptr = (char *)dest->ptr + dest->width;
+			ptr += src->width;
+		}
+
+	return(TRUE);
+}
+
+int IntListCopy(IntListPtr dest, IntListPtr src, long index, unsigned long size)
+{
+	unsigned long start = lists_trace_start(), before = intlist_size(dest);
+	int result = intlist_copy(dest, src, index, size);
+
+	LISTS_PROBE4(copy, dest, src, intlist_size(dest) - before, (intlist_size(dest) - before) * dest->width);
+	lists_trace_stop(LISTS_OP_COPY, start);
+
+	return(result);
+}
+
+int IntListMove(IntListPtr dest, IntListPtr src, long index, unsigned long size)
+{
+	if(!(IntListCopy(dest, src, index, size)))
+		return(FALSE);
+
+	if(!IntListResize(src, 0, 0))
+		return(FALSE);
+
+	return(TRUE);
+}
+
+/* Marks the listed positions in a byte map, or fails if any is out of range */
+unsigned char *lists_index_map(IntListPtr indices, unsigned long size)
+{
+	unsigned char *map;
+	unsigned long i, count = intlist_size(indices);
+	long index;
+
+	if((map = lists_calloc(size ? size : 1, 1)) == NULL)
+		return(NULL);
+
+	for(i = 0; i < count; i++) {
+		index = intlist_load(indices->width, intlist_at(indices, i));
+		if(index < 0)
+			index += size;
+		if(index < 0 || (unsigned long)index >= size) {
+			lists_free(map);
+			return(NULL);
+		}
+		map[index] = 1;
+	}
+
+	return(map);
+}
+
+int IntListRemoveIndices(IntListPtr list, IntListPtr indices)
+{
+	unsigned long i, j, size = intlist_size(list), kept = 0;
+	unsigned char *map;
+
+	if(!(map = lists_index_map(indices, size)))
+		return(FALSE);
+
+	/* One pass, moving each surviving run down in a single copy */
+	for(i = 0; i < size; i = j) {
+		for(; i < size && map[i]; i++);
+		for(j = i; j < size && !map[j]; j++);
+		if(j > i) {
+			if(kept != i)
+				memmove(intlist_at(list, kept), intlist_at(list, i), (j - i) * list->width);
+			kept += j - i;
+		}
+	}
+
+	lists_free(map);
+
+	list->ptr = intlist_at(list, kept);
+
+	IntListReserve(list, 0, 0);
+
+	return(TRUE);
+}
+
+int intlist_qsort_int32(const void *ptr1, const void *ptr2)
+{
+	int32_t a = *(const int32_t *)ptr1, b = *(const int32_t *)ptr2;
+
+	return((a > b) - (a < b));
+}
+
+int IntListSort(IntListPtr list)
+{
+	unsigned long size = intlist_size(list), *count, value, n;
+	char *ptr = list->start;
+	long bias;
+
+	switch(list->width) {
+	case 1:
+	case 2:
+		/* Narrow lanes sort by counting each possible value */
+		n = 1UL << (list->width * 8);
+		bias = n >> 1;
+		if((count = lists_calloc(n, sizeof(unsigned long))) == NULL)
+			return(FALSE);
+		for(value = 0; value < size; value++)
+			count[intlist_load(list->width, ptr + value * list->width) + bias]++;
+		for(value = 0; value < n; value++)
+			while(count[value]--) {
+				intlist_store(list->width, ptr, value - bias);
+				ptr += list->width;
+			}
+		lists_free(count);
+		break;
+	case 4:
+		qsort(ptr, size, 4, intlist_qsort_int32);
+		break;
+	default:
+		qsort(ptr, size, sizeof(long), lists_qsort_long);
+	}
+
+	return(TRUE);
+}
+
+int IntListSortParallel(IntListPtr list, int threads)
+{
+	ListsSortType job;
+
+	if(list->width != sizeof(long))
+		return(IntListSort(list));
+
+	job.start = list->start;
+	job.size = intlist_size(list);
+	job.width = sizeof(long);
+	job.threads = lists_threads(threads);
+	job.cmp_func = lists_sort_long;
+	job.list = NULL;
+
+	return(lists_sort(&job));
+}
+
+int IntListUniqueParallel(IntListPtr list, int threads)
+{
+	ListsSortType job;
+
+	if(!IntListSortParallel(list, threads))
+		return(FALSE);
+
+	job.start = list->start;
+	job.size = intlist_size(list);
+	job.width = list->width;
+	job.threads = lists_threads(threads);
+	job.cmp_func = lists_sort_bytes;
+	job.list = NULL;
+
+	if(!lists_unique(&job))
+		return(FALSE);
+
+	list->ptr = (char *)list->start + job.size * list->width;
+	IntListReserve(list, 0, 0);
+
+	return(TRUE);
+}
+
+/* Int List set functions (inputs sorted ascending without duplicates) */
+#define LISTS_GALLOP	32		/* size ratio above which the smaller list gallops */
+
+typedef unsigned long (IntListSetFunc)(long *out, const long *a, unsigned long n, const long *b, unsigned long m);
+
+/* First index from j on whose value is not below x, by exponential then binary search */
+unsigned long intlist_gallop(const long *b, unsigned long j, unsigned long m, long x)
+{
+	unsigned long lo = j, hi, mid, step = 1;
+
+	if(j >= m || b[j] >= x)
+		return(j);
+
+	while(lo + step < m && b[lo + step] < x) {
+		lo += step;
+		step <<= 1;
+	}
+
+	for(hi = lo + step < m ? lo + step : m; hi - lo > 1;) {
+		mid = lo + (hi - lo) / 2;
+		if(b[mid] < x)
+			lo = mid;
+		else
+			hi = mid;
+	}
+
+	return(hi);
+}
+
+unsigned long intlist_intersect(long *out, const long *a, unsigned long n, const long *b, unsigned long m)
+{
+	unsigned long i = 0, j = 0, k = 0;
+	long x, y, a0, a1, a2, a3, b0, b1, b2, b3;
+
+	if(n * LISTS_GALLOP < m) {
+		for(; i < n && j < m; i++)
+			if((j = intlist_gallop(b, j, m, a[i])) < m && b[j] == a[i])
+				out[k++] = a[i];
+		return(k);
+	}
+
+	if(m * LISTS_GALLOP < n) {
+		for(; j < m && i < n; j++)
+			if((i = intlist_gallop(a, i, n, b[j])) < n && a[i] == b[j])
+				out[k++] = b[j];
+		return(k);
+	}
+
+	/* Every pair of two 4-wide blocks at once; the compares are branch free and vectorize */
+	while(i + 4 <= n && j + 4 <= m) {
+		a0 = a[i]; a1 = a[i + 1]; a2 = a[i + 2]; a3 = a[i + 3];
+		b0 = b[j]; b1 = b[j + 1]; b2 = b[j + 2]; b3 = b[j + 3];
+		out[k] = a0;
+		k += (a0 == b0) | (a0 == b1) | (a0 == b2) | (a0 == b3);
+		out[k] = a1;
+		k += (a1 == b0) | (a1 == b1) | (a1 == b2) | (a1 == b3);
+		out[k] = a2;
+		k += (a2 == b0) | (a2 == b1) | (a2 == b2) | (a2 == b3);
+		out[k] = a3;
+		k += (a3 == b0) | (a3 == b1) | (a3 == b2) | (a3 == b3);
+		i += (a3 <= b3) << 2;
+		j += (b3 <= a3) << 2;
+	}
+
+	while(i < n && j < m) {
+		x = a[i];
+		y = b[j];
+		out[k] = x;
+		k += x == y;
+		i += x <= y;
+		j += y <= x;
+	}
+
+	return(k);
+}
+
+unsigned long intlist_union(long *out, const long *a, unsigned long n, const long *b, unsigned long m)
+{
+	unsigned long i = 0, j = 0, k = 0;
+	long x, y;
+
+	while(i < n && j < m) {
+		x = a[i];
+		y = b[j];
+		out[k++] = x < y ? x : y;
+		i += x <= y;
+		j += y <= x;
+	}
+
+	memcpy(out + k, a + i, (n - i) * sizeof(long));
+	k += n - i;
+	memcpy(out + k, b + j, (m - j) * sizeof(long));
+
+	return(k + m - j);
+}
+
+unsigned long intlist_difference(long *out, const long *a, unsigned long n, const long *b, unsigned long m)
+{
+	unsigned long i = 0, j = 0, k = 0;
+	long x, y;
+
+	if(n * LISTS_GALLOP < m) {
+		for(; i < n; i++)
+			if((j = intlist_gallop(b, j, m, a[i])) >= m || b[j] != a[i])
+				out[k++] = a[i];
+		return(k);
+	}
+
+	while(i < n && j < m) {
+		x = a[i];
+		y = b[j];
+		out[k] = x;
+		k += x < y;
+		i += x <= y;
+		j += y <= x;
+	}
+
+	memcpy(out + k, a + i, (n - i) * sizeof(long));
+
+	return(k + n - i);
+}
+
+unsigned long intlist_symdiff(long *out, const long *a, unsigned long n, const long *b, unsigned long m)
+{
+	unsigned long i = 0, j = 0, k = 0;
+	long x, y;
+
+	while(i < n && j < m) {
+		x = a[i];
+		y = b[j];
+		out[k] = x < y ? x : y;
+		k += x != y;
+		i += x <= y;
+		j += y <= x;
+	}
+
+	memcpy(out + k, a + i, (n - i) * sizeof(long));
+	k += n - i;
+	memcpy(out + k, b + j, (m - j) * sizeof(long));
+
+	return(k + m - j);
+}
+
+/* Empties dest and gives it long lanes with room for size elements */
+long *intlist_set_dest(IntListPtr dest, unsigned long size)
+{
+	dest->ptr = dest->start;
+
+	if(!IntListWiden(dest, sizeof(long)) || !IntListReserve(dest, size, 0))
+		return(NULL);
+
+	return(dest->start);
+}
+
+int intlist_set(IntListPtr dest, IntListPtr a, IntListPtr b, IntListSetFunc *set_func, int grow)
+{
+	unsigned long n = intlist_size(a), m = intlist_size(b);
+	long *x, *y, *tmp[2] = { NULL, NULL }, *out;
+	int ok = FALSE;
+
+	if(dest == a || dest == b)
+		return(FALSE);
+
+	if((x = intlist_longs(a, tmp)) && (y = intlist_longs(b, tmp + 1))
+			&& (out = intlist_set_dest(dest, grow ? n + m : n))) {
+		dest->ptr = out + set_func(out, x, n, y, m);
+		ok = TRUE;
+	}
+
+	lists_free(tmp[0]);
+	lists_free(tmp[1]);
+
+	return(ok);
+}
+
+int IntListUnion(IntListPtr dest, IntListPtr a, IntListPtr b)
+{
+	return(intlist_set(dest, a, b, intlist_union, TRUE));
+}
+
+int IntListIntersect(IntListPtr dest, IntListPtr a, IntListPtr b)
+{
+	return(intlist_set(dest, a, b, intlist_intersect, FALSE));
+}
+
+int IntListDifference(IntListPtr dest, IntListPtr a, IntListPtr b)
+{
+	return(intlist_set(dest, a, b, intlist_difference, FALSE));
+}
+
+int IntListSymDiff(IntListPtr dest, IntListPtr a, IntListPtr b)
+{
+	return(intlist_set(dest, a, b, intlist_symdiff, TRUE));
+}
+
+/* Intersects smallest first, alternating between dest and a scratch run, until nothing is left */
+int IntListIntersectMany(IntListPtr dest, IntListPtr *lists, int count)
+{
+	IntListPtr list;
+	unsigned long k;
+	long *out, *run, *next, *longs, *tmp;
+	int i, j, ok = TRUE;
+
+	for(i = 0; i < count; i++)
+		if(lists[i] == dest)
+			return(FALSE);
+
+	for(i = 1; i < count; i++) {
+		for(j = i, list = lists[i]; j && intlist_size(lists[j - 1]) > intlist_size(list); j--)
+			lists[j] = lists[j - 1];
+		lists[j] = list;
+	}
+
+	if((out = intlist_set_dest(dest, count ? intlist_size(lists[0]) : 0)) == NULL)
+		return(FALSE);
+
+	if(!count)
+		return(TRUE);
+
+	k = intlist_size(lists[0]);
+	if((longs = intlist_longs(lists[0], &tmp)) == NULL || (run = lists_malloc((k ? k : 1) * sizeof(long))) == NULL) {
+		lists_free(tmp);
+		return(FALSE);
+	}
+	memcpy(out, longs, k * sizeof(long));
+	lists_free(tmp);
+
+	for(i = 1, next = run; i < count && k; i++) {
+		if((longs = intlist_longs(lists[i], &tmp)) == NULL) {
+			ok = FALSE;
+			break;
+		}
+		k = intlist_intersect(next, next == run ? out : run, k, longs, intlist_size(lists[i]));
+		next = next == run ? out : run;
+		lists_free(tmp);
+	}
+
+	/* The last pass wrote into whichever buffer next no longer points at */
+	if(next == out)
+		memcpy(out, run, k * sizeof(long));
+	lists_free(run);
+
+	dest->ptr = out + k;
+
+	return(ok);
+}
+
+/* Int List heap functions */
+#define LISTS_SELECT_MIN	16		/* ranges this small are finished by insertion sort */
+
+int intlist_heap_before(long a, long b, int flags)
+{
+	return(flags & LISTS_HEAP_MAX ? a > b : a < b);
+}
+
+void intlist_sift_up(char *base, size_t width, unsigned long i, int flags)
+{
+	unsigned long d = flags & LISTS_HEAP_4ARY ? 4 : 2, parent;
+	long value = intlist_load(width, base + i * width), up;
+
+	for(; i && intlist_heap_before(value, up = intlist_load(width, base + (parent = (i - 1) / d) * width), flags); i = parent)
+		intlist_store(width, base + i * width, up);
+
+	intlist_store(width, base + i * width, value);
+}
+
+void intlist_sift_down(char *base, size_t width, unsigned long i, unsigned long size, int flags)
+{
+	unsigned long d = flags & LISTS_HEAP_4ARY ? 4 : 2, child, best, last;
+	long value = intlist_load(width, base + i * width), x, y;
+
+	while((child = i * d + 1) < size) {
+		last = child + d < size ? child + d : size;
+		for(best = child++, x = intlist_load(width, base + best * width); child < last; child++)
+			if(intlist_heap_before(y = intlist_load(width, base + child * width), x, flags)) {
+				best = child;
+				x = y;
+			}
+
+		if(!intlist_heap_before(x, value, flags))
+			break;
+
+		intlist_store(width, base + i * width, x);
+		i = best;
+	}
+
+	intlist_store(width, base + i * width, value);
+}
+
+void intlist_heapify(char *base, size_t width, unsigned long size, int flags)
+{
+	unsigned long d = flags & LISTS_HEAP_4ARY ? 4 : 2, i;
+
+	if(size < 2)
+		return;
+
+	for(i = (size - 2) / d + 1; i--;)
+		intlist_sift_down(base, width, i, size, flags);
+}
+
+int IntListHeapify(IntListPtr list, int flags)
+{
+	intlist_heapify(list->start, list->width, intlist_size(list), flags);
+
+	return(TRUE);
+}
+
+int IntListHeapPush(IntListPtr list, long value, int flags)
+{
+	if(!IntListPush(list, value))
+		return(FALSE);
+
+	intlist_sift_up(list->start, list->width, intlist_size(list) - 1, flags);
+
+	return(TRUE);
+}
+
+int IntListHeapPop(IntListPtr list, long *value, int flags)
+{
+	long top, last;
+
+	if(!IntListGet(list, 0, &top) || !IntListPop(list, &last))
+		return(FALSE);
+
+	if(intlist_size(list)) {
+		intlist_store(list->width, list->start, last);
+		intlist_sift_down(list->start, list->width, 0, intlist_size(list), flags);
+	}
+
+	if(value)
+		*value = top;
+
+	return(TRUE);
+}
+
+/* Pop then push in a single sift */
+int IntListHeapReplace(IntListPtr list, long value, long *top, int flags)
+{
+	if(!IntListGet(list, 0, top) || !intlist_put(list, 0, value))
+		return(FALSE);
+
+	intlist_sift_down(list->start, list->width, 0, intlist_size(list), flags);
+
+	return(TRUE);
+}
+
+int IntListHeapPeek(IntListPtr list, long *value)
+{
+	return(IntListGet(list, 0, value));
+}
+
+/* The k best of size longs into the front: a heap of the opposite order keeps the k best seen */
+void intlist_heap_select(long *a, unsigned long size, unsigned long k, int flags)
+{
+	unsigned long i;
+	long swap;
+
+	intlist_heapify((char *)a, sizeof(long), k, flags ^ LISTS_HEAP_MAX);
+
+	for(i = k; i < size; i++)
+		if(intlist_heap_before(a[i], a[0], flags)) {
+			swap = a[i];
+			a[i] = a[0];
+			a[0] = swap;
+			intlist_sift_down((char *)a, sizeof(long), 0, k, flags ^ LISTS_HEAP_MAX);
+		}
+}
+
+/* Introselect: median of three quickselect, falling back to heap selection when it degrades */
+void intlist_select(long *a, unsigned long size, unsigned long k, int flags)
+{
+	unsigned long lo = 0, hi = size, depth = 0;
+	long i, j;
+	long pivot, swap, x, y, z;
+
+	if(!k || k >= size)
+		return;
+
+	if(k * 64 < size) {
+		intlist_heap_select(a, size, k, flags);
+		return;
+	}
+
+	for(i = size; i; i >>= 1)
+		depth += 2;
+
+	while(hi - lo > LISTS_SELECT_MIN) {
+		if(!depth--) {
+			intlist_heap_select(a + lo, hi - lo, k - lo, flags);
+			return;
+		}
+
+		x = a[lo];
+		y = a[lo + (hi - lo) / 2];
+		z = a[hi - 1];
+		if(intlist_heap_before(y, x, flags)) {
+			swap = x; x = y; y = swap;
+		}
+		pivot = intlist_heap_before(z, y, flags) ? (intlist_heap_before(z, x, flags) ? x : z) : y;
+
+		for(i = lo, j = hi - 1; i <= j;) {
+			while(intlist_heap_before(a[i], pivot, flags))
+				i++;
+			while(intlist_heap_before(pivot, a[j], flags))
+				j--;
+			if(i <= j) {
+				swap = a[i];
+				a[i++] = a[j];
+				a[j--] = swap;
+			}
+		}
+
+		if((long)k <= j)
+			hi = j + 1;
+		else if((long)k >= i)
+			lo = i;
+		else
+			return;
+	}
+
+	for(i = lo + 1; i < (long)hi; i++) {
+		for(x = a[i], j = i; j > (long)lo && intlist_heap_before(x, a[j - 1], flags); j--)
+			a[j] = a[j - 1];
+		a[j] = x;
+	}
+}
+
+int IntListPartialSort(IntListPtr list, unsigned long k, int flags)
+{
+	unsigned long i, size = intlist_size(list);
+	long *longs, *tmp, swap;
+
+	if(k > size)
+		k = size;
+
+	if((longs = intlist_longs(list, &tmp)) == NULL)
+		return(FALSE);
+
+	intlist_select(longs, size, k, flags);
+	qsort(longs, k, sizeof(long), lists_qsort_long);
+	if(flags & LISTS_HEAP_MAX)
+		for(i = 0; i < k / 2; i++) {
+			swap = longs[i];
+			longs[i] = longs[k - 1 - i];
+			longs[k - 1 - i] = swap;
+		}
+
+	if(tmp) {
+		for(i = 0; i < size; i++)
+			intlist_store(list->width, intlist_at(list, i), tmp[i]);
+		lists_free(tmp);
+	}
+
+	return(TRUE);
+}
+
+/* Int List distinct value functions (open addressing, linear probing, half full at most) */
+typedef struct {
+	unsigned long *hash;
+	unsigned long *index;	/* position + 1 of the value's first occurrence, 0 when free */
+	long *key;
+	unsigned long mask;
+	unsigned long count;
+} ListsTableType;
+typedef ListsTableType *ListsTablePtr;
+
+unsigned long lists_hash_long(long value)
+{
+	uint64_t h = (uint64_t)value;
+
+	/* 64-bit finalizer from MurmurHash3 */
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb3fe1a85ec53ULL;
+	h ^= h >> 33;
+
+	return((unsigned long)h);
+}
+
+int lists_table_init(ListsTablePtr table, unsigned long expect, int keys)
+{
+	unsigned long size = 16;
+
+	while(size < expect * 2)
+		size <<= 1;
+
+	table->mask = size - 1;
+	table->count = 0;
+	table->hash = lists_malloc(size * sizeof(unsigned long));
+	table->index = lists_calloc(size, sizeof(unsigned long));
+	table->key = keys ? lists_malloc(size * sizeof(long)) : NULL;
+
+	if(!table->hash || !table->index || (keys && !table->key)) {
+		lists_free(table->hash);
+		lists_free(table->index);
+		lists_free(table->key);
+		return(FALSE);
+	}
+
+	return(TRUE);
+}
+
+void lists_table_free(ListsTablePtr table)
+{
+	lists_free(table->hash);
+	lists_free(table->index);
+	lists_free(table->key);
+}
+
+/* Doubles the table once it is half full, moving entries by their stored hashes */
+int lists_table_grow(ListsTablePtr table)
+{
+	ListsTableType old = *table;
+	unsigned long i, slot;
+
+	if(table->count * 2 < table->mask + 1)
+		return(TRUE);
+
+	if(!lists_table_init(table, table->mask + 1, old.key != NULL)) {
+		*table = old;
+		return(FALSE);
+	}
+
+	for(i = 0; i <= old.mask; i++)
+		if(old.index[i]) {
+			for(slot = old.hash[i] & table->mask; table->index[slot]; slot = (slot + 1) & table->mask);
+			table->hash[slot] = old.hash[i];
+			table->index[slot] = old.index[i];
+			if(old.key)
+				table->key[slot] = old.key[i];
+		}
+	table->count = old.count;
+
+	lists_table_free(&old);
+
+	return(TRUE);
+}
+
+/* Returns the value's index + 1, or 0 after adding it as index + 1 == position */
+unsigned long lists_table_long(ListsTablePtr table, long value, unsigned long position)
+{
+	unsigned long hash = lists_hash_long(value), slot;
+
+	for(slot = hash & table->mask; table->index[slot]; slot = (slot + 1) & table->mask)
+		if(table->key[slot] == value)
+			return(table->index[slot]);
+
+	table->hash[slot] = hash;
+	table->index[slot] = position;
+	table->key[slot] = value;
+	table->count++;
+
+	return(0);
+}
+
+/* Approximate natural log, so the estimate needs no libm */
+double lists_log(double x)
+{
+	double y, y2, sum = 0.0, term;
+	int n, exp = 0;
+
+	while(x > 1.5) {
+		x /= 2.0;
+		exp++;
+	}
+	while(x < 0.75) {
+		x *= 2.0;
+		exp--;
+	}
+
+	y = (x - 1.0) / (x + 1.0);
+	y2 = y * y;
+	for(n = 1, term = y; n < 20; n += 2, term *= y2)
+		sum += term / n;
+
+	return(2.0 * sum + exp * 0.69314718055994530942);
+}
+
+/* HyperLogLog register update and estimate, 2^12 registers */
+#define LISTS_HLL_BITS	12
+
+void lists_hll_add(unsigned char *reg, uint64_t hash)
+{
+	unsigned long index = hash >> (64 - LISTS_HLL_BITS);
+	unsigned char rank = 1;
+
+	for(hash <<= LISTS_HLL_BITS; rank <= 64 - LISTS_HLL_BITS && !(hash & (1ULL << 63)); hash <<= 1)
+		rank++;
+
+	if(rank > reg[index])
+		reg[index] = rank;
+}
+
+unsigned long lists_hll_estimate(unsigned char *reg)
+{
+	double m = 1 << LISTS_HLL_BITS, sum = 0.0, estimate;
+	unsigned long i, zeros = 0;
+
+	for(i = 0; i < (1 << LISTS_HLL_BITS); i++) {
+		sum += 1.0 / (double)(1ULL << reg[i]);
+		zeros += !reg[i];
+	}
+
+	estimate = 0.7213 / (1.0 + 1.079 / m) * m * m / sum;
+
+	/* Small cardinalities count empty registers instead */
+	if(estimate <= 2.5 * m && zeros)
+		estimate = m * lists_log(m / zeros);
+
+	return((unsigned long)(estimate + 0.5));
+}
+
+unsigned long IntListEstimate(IntListPtr list)
+{
+	unsigned char reg[1 << LISTS_HLL_BITS];
+	unsigned long i, size = intlist_size(list);
+
+	memset(reg, 0, sizeof(reg));
+
+	for(i = 0; i < size; i++)
+		lists_hll_add(reg, lists_hash_long(intlist_load(list->width, intlist_at(list, i))));
+
+	return(lists_hll_estimate(reg));
+}
+
+/* Keeps first occurrences in order; expect presizes the table (0 grows it on demand) */
+int IntListUnique(IntListPtr list, unsigned long expect)
+{
+	ListsTableType table;
+	unsigned long i, size = intlist_size(list), keep = 0;
+	long value;
+
+	if(!lists_table_init(&table, expect, TRUE))
+		return(FALSE);
+
+	for(i = 0; i < size; i++) {
+		value = intlist_load(list->width, intlist_at(list, i));
+		if(!lists_table_long(&table, value, keep + 1)) {
+			intlist_store(list->width, intlist_at(list, keep++), value);
+			if(!lists_table_grow(&table)) {
+				lists_table_free(&table);
+				return(FALSE);
+			}
+		}
+	}
+
+	lists_table_free(&table);
+
+	/* The kept values are already in place; drop the tail */
+	list->ptr = intlist_at(list, keep);
+	IntListReserve(list, 0, 0);
+
+	return(TRUE);
+}
+
+/* Fills values with the distinct values in first-seen order and counts with their tallies */
+int IntListCount(IntListPtr list, IntListPtr values, IntListPtr counts, unsigned long expect)
+{
+	ListsTableType table;
+	unsigned long i, size = intlist_size(list), index;
+	long value;
+	int ok = TRUE;
+
+	values->ptr = values->start;
+	counts->ptr = counts->start;
+
+	if(!IntListWiden(counts, sizeof(long)) || !lists_table_init(&table, expect, TRUE))
+		return(FALSE);
+
+	for(i = 0; i < size && ok; i++) {
+		value = intlist_load(list->width, intlist_at(list, i));
+		if((index = lists_table_long(&table, value, intlist_size(values) + 1)))
+			((long *)counts->start)[index - 1]++;
+		else
+			ok = IntListPush(values, value) && IntListPush(counts, 1) && lists_table_grow(&table);
+	}
+
+	lists_table_free(&table);
+
+	return(ok);
+}
+
+int IntListRemoveIf(IntListPtr list, IntListFilterFunc remove_func, void *custom)
+{
+	unsigned long i, size = intlist_size(list), kept = 0;
+	char *ptr;
+
+	for(i = 0; i < size; i++) {
+		ptr = intlist_at(list, i);
+		if(!remove_func(list, intlist_load(list->width, ptr), custom)) {
+			if(kept != i)
+				memcpy(intlist_at(list, kept), ptr, list->width);
+			kept++;
+		}
+	}
+
+	if(kept == size)
+		return(TRUE);
+
+	list->ptr = intlist_at(list, kept);
+
+	IntListReserve(list, 0, 0);
+
+	return(TRUE);
+}
+
+int IntListSwapRemove(IntListPtr list, long index)
+{
+	unsigned long size;
+	char *ptr;
+
+	if(!(ptr = intlist_index(list, index)))
+		return(FALSE);
+
+	list->ptr = (char *)list->ptr - list->width;
+
+	if(ptr != (char *)list->ptr)
+		memcpy(ptr, list->ptr, list->width);
+
+	if(list->reserve - (list->grow << 1) >= (size = intlist_size(list)))
+		IntListReserve(list, size, 0);
+
+	return(TRUE);
+}
+
+/* Int List mapping functions */
+int IntListMap(IntListPtr list, IntListMapFunc map_func, void *custom)
+{
+	unsigned long index = 0, size = intlist_size(list);
+	long value = 0;
+
+	/* Typed loop per lane width; a result too wide for the lanes widens the list and resumes there */
+	while(index < size) {
+		switch(list->width) {
+		case 1:
+			for(; index < size; index++) {
+				value = map_func(list, index, ((int8_t *)list->start)[index], custom);
+				if(value != (int8_t)value)
+					break;
+				((int8_t *)list->start)[index] = (int8_t)value;
+			}
+			break;
+		case 2:
+			for(; index < size; index++) {
+				value = map_func(list, index, ((int16_t *)list->start)[index], custom);
+				if(value != (int16_t)value)
+					break;
+				((int16_t *)list->start)[index] = (int16_t)value;
+			}
+			break;
+		case 4:
+			for(; index < size; index++) {
+				value = map_func(list, index, ((int32_t *)list->start)[index], custom);
+				if(value != (int32_t)value)
+					break;
+				((int32_t *)list->start)[index] = (int32_t)value;
+			}
+			break;
+		default:
+			for(; index < size; index++)
+				((long *)list->start)[index] = map_func(list, index, ((long *)list->start)[index], custom);
+		}
+
+		if(index < size && !intlist_put(list, index++, value))
+			return(FALSE);
+	}
+
+	return(TRUE);
+}
+
+int intlist_filter(IntListPtr list, IntListFilterFunc filter_func, void *custom)
+{
+	char *ptr = list->ptr;
+	long n;
+
+	while((ptr -= list->width) >= (char *)list->start)
+		if(!filter_func(list, intlist_load(list->width, ptr), custom)) {
+			list->ptr = (char *)list->ptr - list->width;
+			if((n = (char *)list->ptr - ptr))
+				memmove(ptr, ptr + list->width, n);
+		}
+
+	return(TRUE);
+}
+
+int IntListFilter(IntListPtr list, IntListFilterFunc filter_func, void *custom)
+{
+	unsigned long start = lists_trace_start(), before = intlist_size(list);
+	int result = intlist_filter(list, filter_func, custom);
+
+	LISTS_PROBE3(filter, list, before, intlist_size(list));
+	lists_trace_stop(LISTS_OP_FILTER, start);
+
+	return(result);
+}
+
+int IntListReduce(IntListPtr list, IntListReduceFunc reduce_func, long *value, long initial, void *custom)
+{
+	long n = intlist_size(list);
+
+	switch(list->width) {
+	case 1:
+		while(--n >= 0)
+			initial = reduce_func(list, initial, ((int8_t *)list->start)[n], custom);
+		break;
+	case 2:
+		while(--n >= 0)
+			initial = reduce_func(list, initial, ((int16_t *)list->start)[n], custom);
+		break;
+	case 4:
+		while(--n >= 0)
+			initial = reduce_func(list, initial, ((int32_t *)list->start)[n], custom);
+		break;
+	default:
+		while(--n >= 0)
+			initial = reduce_func(list, initial, ((long *)list->start)[n], custom);
+	}
+
+	if(value)
+		*value = initial;
+
+	return(TRUE);
+}
+
+/* Int List block mapping functions */
+int IntListMapBlock(IntListPtr list, IntListMapBlockFunc map_func, unsigned long block, void *custom)
+{
+	unsigned long index, count, n, size = intlist_size(list);
+	long *tmp;
+
+	if(!block)
+		block = LISTS_BLOCK;
+
+	if((tmp = lists_malloc(block * sizeof(long))) == NULL)
+		return(FALSE);
+
+	for(index = 0; index < size; index += count) {
+		count = size - index < block ? size - index : block;
+
+		/* Long lanes are handed over in place, narrow ones through a widened copy */
+		if(list->width == sizeof(long)) {
+			map_func(list, index, (long *)list->start + index, count, custom);
+			continue;
+		}
+
+		for(n = 0; n < count; n++)
+			tmp[n] = intlist_load(list->width, intlist_at(list, index + n));
+		map_func(list, index, tmp, count, custom);
+		for(n = 0; n < count; n++)
+			if(!intlist_put(list, index + n, tmp[n])) {
+				lists_free(tmp);
+				return(FALSE);
+			}
+	}
+
+	lists_free(tmp);
+
+	return(TRUE);
+}
+
+int IntListFilterBlock(IntListPtr list, IntListFilterBlockFunc filter_func, unsigned long block, void *custom)
+{
+	unsigned long index, count, n, kept, keep = 0, size = intlist_size(list);
+	unsigned char *mask;
+	long *values, *tmp;
+	size_t width = list->width;
+
+	if(!block)
+		block = LISTS_BLOCK;
+
+	mask = lists_malloc(block);
+	tmp = lists_malloc(block * sizeof(long));
+	if(!mask || !tmp) {
+		lists_free(mask);
+		lists_free(tmp);
+		return(FALSE);
+	}
+
+	for(index = 0; index < size; index += count) {
+		count = size - index < block ? size - index : block;
+
+		if(width == sizeof(long))
+			values = (long *)list->start + index;
+		else
+			for(n = 0, values = tmp; n < count; n++)
+				tmp[n] = intlist_load(width, intlist_at(list, index + n));
+
+		/* Whole blocks kept only need moving down over earlier gaps */
+		if((kept = filter_func(list, values, mask, count, custom)) == count) {
+			if(keep != index)
+				memmove(intlist_at(list, keep), intlist_at(list, index), count * width);
+			keep += count;
+		} else if(kept)
+			for(n = 0; n < count; n++)
+				if(mask[n])
+					intlist_store(width, intlist_at(list, keep++), values[n]);
+	}
+
+	lists_free(mask);
+	lists_free(tmp);
+
+	list->ptr = intlist_at(list, keep);
+
+	return(TRUE);
+}
+
+int IntListReduceBlock(IntListPtr list, IntListReduceBlockFunc reduce_func, unsigned long block, long *value, long initial, void *custom)
+{
+	unsigned long index, count, n, size = intlist_size(list);
+	long *tmp;
+
+	if(!block)
+		block = LISTS_BLOCK;
+
+	if((tmp = lists_malloc(block * sizeof(long))) == NULL)
+		return(FALSE);
+
+	for(index = 0; index < size; index += count) {
+		count = size - index < block ? size - index : block;
+
+		if(list->width == sizeof(long))
+			initial = reduce_func(list, initial, (long *)list->start + index, count, custom);
+		else {
+			for(n = 0; n < count; n++)
+				tmp[n] = intlist_load(list->width, intlist_at(list, index + n));
+			initial = reduce_func(list, initial, tmp, count, custom);
+		}
+	}
+
+	lists_free(tmp);
+
+	if(value)
+		*value = initial;
+
+	return(TRUE);
+}
+
+/* Int List pipeline functions */
+int IntListPipeInit(IntListPipePtr pipeline, IntListPtr list)
+{
+	pipeline->list = list;
+	pipeline->size = 0;
+
+	return(TRUE);
+}
+
+IntListStagePtr intlist_pipe_stage(IntListPipePtr pipeline, int type, unsigned long n, void *custom)
+{
+	IntListStagePtr stage;
+
+	if(pipeline->size >= LISTS_PIPE_MAX)
+		return(NULL);
+
+	stage = pipeline->stage + pipeline->size++;
+	stage->type = type;
+	stage->map_func = NULL;
+	stage->filter_func = NULL;
+	stage->n = n;
+	stage->custom = custom;
+
+	return(stage);
+}
+
+int IntListPipeMap(IntListPipePtr pipeline, IntListMapFunc map_func, void *custom)
+{
+	IntListStagePtr stage;
+
+	if(!(stage = intlist_pipe_stage(pipeline, LISTS_PIPE_MAP, 0, custom)))
+		return(FALSE);
+
+	stage->map_func = map_func;
+
+	return(TRUE);
+}
+
+int IntListPipeFilter(IntListPipePtr pipeline, IntListFilterFunc filter_func, void *custom)
+{
+	IntListStagePtr stage;
+
+	if(!(stage = intlist_pipe_stage(pipeline, LISTS_PIPE_FILTER, 0, custom)))
+		return(FALSE);
+
+	stage->filter_func = filter_func;
+
+	return(TRUE);
+}
+
+int IntListPipeTake(IntListPipePtr pipeline, unsigned long n)
+{
+	return(intlist_pipe_stage(pipeline, LISTS_PIPE_TAKE, n, NULL) != NULL);
+}
+
+int IntListPipeSkip(IntListPipePtr pipeline, unsigned long n)
+{
+	return(intlist_pipe_stage(pipeline, LISTS_PIPE_SKIP, n, NULL) != NULL);
+}
+
+/* Runs one value through every stage: 1 = passed, 0 = dropped, -1 = pipeline exhausted */
+int intlist_pipe_apply(IntListPipePtr pipeline, unsigned long *seen, long *value)
+{
+	IntListStagePtr stage = pipeline->stage;
+	int i;
+
+	for(i = 0; i < pipeline->size; i++, stage++)
+		switch(stage->type) {
+		case LISTS_PIPE_MAP:
+			*value = stage->map_func(pipeline->list, seen[i]++, *value, stage->custom);
+			break;
+		case LISTS_PIPE_FILTER:
+			if(!stage->filter_func(pipeline->list, *value, stage->custom))
+				return(0);
+			break;
+		case LISTS_PIPE_TAKE:
+			if(seen[i] >= stage->n)
+				return(-1);
+			seen[i]++;
+			break;
+		case LISTS_PIPE_SKIP:
+			if(seen[i] < stage->n) {
+				seen[i]++;
+				return(0);
+			}
+			break;
+		}
+
+	return(1);
+}
+
+int IntListPipeReduce(IntListPipePtr pipeline, IntListReduceFunc reduce_func, long *value, long initial, void *custom)
+{
+	IntListPtr list = pipeline->list;
+	unsigned long seen[LISTS_PIPE_MAX] = { 0 };
+	char *ptr = list->start;
+	long x;
+	int pass;
+
+	while(ptr < (char *)list->ptr) {
+		x = intlist_load(list->width, ptr);
+		ptr += list->width;
+		if((pass = intlist_pipe_apply(pipeline, seen, &x)) < 0)
+			break;
+		if(pass)
+			initial = reduce_func(list, initial, x, custom);
+	}
+
+	if(value)
+		*value = initial;
+
+	return(TRUE);
+}
+
+long IntListPipeCount(IntListPipePtr pipeline)
+{
+	IntListPtr list = pipeline->list;
+	unsigned long seen[LISTS_PIPE_MAX] = { 0 };
+	char *ptr = list->start;
+	long x, count = 0;
+	int pass;
+
+	while(ptr < (char *)list->ptr) {
+		x = intlist_load(list->width, ptr);
+		ptr += list->width;
+		if((pass = intlist_pipe_apply(pipeline, seen, &x)) < 0)
+			break;
+		count += pass;
+	}
+
+	return(count);
+}
+
+int IntListPipeCollect(IntListPipePtr pipeline, IntListPtr dest)
+{
+	IntListPtr list = pipeline->list;
+	unsigned long seen[LISTS_PIPE_MAX] = { 0 },
+			size = intlist_size(list), n = intlist_size(dest);
+	char *ptr = list->start, *end = list->ptr;
+	long x;
+	int i, pass;
+
+	if(dest == list)
+		return(FALSE);
+
+	/* Every take stage caps the output, so reserve for the tightest one */
+	for(i = 0; i < pipeline->size; i++)
+		if(pipeline->stage[i].type == LISTS_PIPE_TAKE && pipeline->stage[i].n < size)
+			size = pipeline->stage[i].n;
+
+	if(!IntListReserve(dest, n + size, dest->grow ? 0 : list->grow))
+		return(FALSE);
+
+	while(ptr < end) {
+		x = intlist_load(list->width, ptr);
+		ptr += list->width;
+		if((pass = intlist_pipe_apply(pipeline, seen, &x)) < 0)
+			break;
+		if(pass) {
+			if(!intlist_put(dest, n, x))
+				return(FALSE);
+			dest->ptr = intlist_at(dest, ++n);
+		}
+	}
+
+	return(TRUE);
+}
+
+long IntListPipeFind(IntListPipePtr pipeline, long *value)
+{
+	IntListPtr list = pipeline->list;
+	unsigned long seen[LISTS_PIPE_MAX] = { 0 };
+	char *ptr = list->start;
+	long x;
+	int pass;
+
+	while(ptr < (char *)list->ptr) {
+		x = intlist_load(list->width, ptr);
+		ptr += list->width;
+		if((pass = intlist_pipe_apply(pipeline, seen, &x)) < 0)
+			break;
+		if(pass) {
+			if(value)
+				*value = x;
+			return(((ptr - (char *)list->start) >> list->shift) - 1);
+		}
+	}
+
+	return(-1);
+}
+
+/* Packed Int List functions */
+unsigned long long intlist_load64(unsigned char *src)
+{
+	return((unsigned long long)src[0] | (unsigned long long)src[1] << 8 |
+			(unsigned long long)src[2] << 16 | (unsigned long long)src[3] << 24 |
+			(unsigned long long)src[4] << 32 | (unsigned long long)src[5] << 40 |
+			(unsigned long long)src[6] << 48 | (unsigned long long)src[7] << 56);
+}
+
+int intlist_bits(unsigned long value)
+{
+	int bits = 0;
+
+	while(value) {
+		bits++;
+		value >>= 1;
+	}
+
+	return(bits);
+}
+
+void intlist_pack_block(unsigned char *dest, long *src, unsigned long n, IntListBlockPtr block)
+{
+	unsigned long i, p, v, prev = block->base;
+	unsigned char *ptr;
+	int shift, k;
+
+	if(!block->bits)
+		return;
+
+	for(i = 0, p = 0; i < n; i++, p += block->bits) {
+		if(block->delta) {
+			v = (unsigned long)src[i] - prev;
+			prev = src[i];
+		} else
+			v = (unsigned long)src[i] - (unsigned long)block->base;
+
+		ptr = dest + (p >> 3);
+		shift = p & 7;
+		*ptr |= (unsigned char)(v << shift);
+		v >>= 8 - shift;
+		for(k = 8 - shift; k < block->bits; k += 8) {
+			*++ptr |= (unsigned char)v;
+			v >>= 8;
+		}
+	}
+}
+
+/* Fixed-width, branch-free inner loops so the compiler can vectorise them */
+void intlist_unpack_block(long *dest, unsigned char *src, unsigned long n, IntListBlockPtr block)
+{
+	unsigned long long mask, word;
+	unsigned long i, p, acc;
+	int bits = block->bits;
+
+	if(!bits)
+		memset(dest, 0, n * sizeof(long));
+	else if(bits <= 56) {
+		mask = (1ULL << bits) - 1;
+		for(i = 0, p = 0; i < n; i++, p += bits)
+			dest[i] = (long)((intlist_load64(src + (p >> 3)) >> (p & 7)) & mask);
+	} else {
+		mask = bits < 64 ? (1ULL << bits) - 1 : ~0ULL;
+		for(i = 0, p = 0; i < n; i++, p += bits) {
+			word = intlist_load64(src + (p >> 3)) >> (p & 7);
+			if(p & 7)
+				word |= (unsigned long long)src[(p >> 3) + 8] << (64 - (p & 7));
+			dest[i] = (long)(word & mask);
+		}
+	}
+
+	if(block->delta)
+		for(i = 0, acc = block->base; i < n; i++) {
+			acc += (unsigned long)dest[i];
+			dest[i] = (long)acc;
+		}
+	else
+		for(i = 0; i < n; i++)
+			dest[i] = (long)((unsigned long)dest[i] + (unsigned long)block->base);
+}
+
+unsigned long intlist_pack_count(IntListPackPtr pack, unsigned long block)
+{
+	unsigned long n = pack->size - block * INTLIST_PACK_BLOCK;
+
+	return(n < INTLIST_PACK_BLOCK ? n : INTLIST_PACK_BLOCK);
+}
+
+int IntListCompress(IntListPackPtr pack, IntListPtr list)
+{
+	unsigned long size = intlist_size(list), i, j, n, delta;
+	long *src, *tmp, *longs, min, max;
+	IntListBlockPtr block;
+	unsigned char *data;
+	int sorted, delta_bits;
+
+	pack->size = size;
+	pack->blocks = (size + INTLIST_PACK_BLOCK - 1) / INTLIST_PACK_BLOCK;
+	pack->bytes = 0;
+	pack->block = NULL;
+	pack->data = NULL;
+
+	if((longs = intlist_longs(list, &tmp)) == NULL)
+		return(FALSE);
+
+	/* Worst case is a full 64 bits per value, plus slack for unaligned word loads */
+	if((pack->data = lists_calloc(size * sizeof(long) + 9, 1)) == NULL ||
+			(pack->blocks && (pack->block = lists_malloc(pack->blocks * sizeof(IntListBlockType))) == NULL)) {
+		IntListPackFree(pack);
+		lists_free(tmp);
+		return(FALSE);
+	}
+
+	for(i = 0; i < pack->blocks; i++) {
+		block = pack->block + i;
+		src = longs + i * INTLIST_PACK_BLOCK;
+		n = intlist_pack_count(pack, i);
+
+		min = max = src[0];
+		sorted = TRUE;
+		delta = 0;
+		for(j = 1; j < n; j++) {
+			if(src[j] < min)
+				min = src[j];
+			if(src[j] > max)
+				max = src[j];
+			if(src[j] < src[j - 1])
+				sorted = FALSE;
+			else if((unsigned long)src[j] - (unsigned long)src[j - 1] > delta)
+				delta = (unsigned long)src[j] - (unsigned long)src[j - 1];
+		}
+
+		block->base = min;
+		block->max = max;
+		block->offset = pack->bytes;
+		block->bits = intlist_bits((unsigned long)max - (unsigned long)min);
+		block->delta = FALSE;
+
+		/* Sorted runs store the gaps instead when they are narrower */
+		if(sorted && (delta_bits = intlist_bits(delta)) < block->bits) {
+			block->bits = delta_bits;
+			block->delta = TRUE;
+		}
+
+		intlist_pack_block(pack->data + pack->bytes, src, n, block);
+		pack->bytes += (n * block->bits + 7) >> 3;
+	}
+
+	if((data = lists_realloc(pack->data, pack->bytes + 9)) != NULL)
+		pack->data = data;
+
+	lists_free(tmp);
+
+	return(TRUE);
+}
+
+int IntListDecompress(IntListPtr list, IntListPackPtr pack)
+{
+	long buffer[INTLIST_PACK_BLOCK];
+	unsigned long i, j, n, size = intlist_size(list);
+
+	if(!IntListReserve(list, size + pack->size, list->grow ? 0 : INTLIST_PACK_BLOCK))
+		return(FALSE);
+
+	for(i = 0; i < pack->blocks; i++) {
+		n = intlist_pack_count(pack, i);
+
+		/* Full-width lists are decoded straight into place */
+		if(list->width == sizeof(long)) {
+			intlist_unpack_block((long *)list->ptr, pack->data + pack->block[i].offset, n, pack->block + i);
+			size += n;
+		} else {
+			intlist_unpack_block(buffer, pack->data + pack->block[i].offset, n, pack->block + i);
+			for(j = 0; j < n; j++) {
+				if(!intlist_put(list, size, buffer[j]))
+					return(FALSE);
+				list->ptr = intlist_at(list, ++size);
+			}
+		}
+
+		list->ptr = intlist_at(list, size);
+	}
+
+	return(TRUE);
+}
+
+void IntListPackFree(IntListPackPtr pack)
+{
+	lists_free(pack->block);
+	lists_free(pack->data);
+
+	pack->block = NULL;
+	pack->data = NULL;
+	pack->size = pack->blocks = pack->bytes = 0;
+}
+
+long IntListPackSize(IntListPackPtr pack)
+{
+	return(pack->size);
+}
+
+unsigned long IntListPackBytes(IntListPackPtr pack)
+{
+	return(pack->blocks * sizeof(IntListBlockType) + pack->bytes);
+}
+
+int IntListPackGet(IntListPackPtr pack, long index, long *value)
+{
+	long buffer[INTLIST_PACK_BLOCK];
+	unsigned long block;
+
+	if(index < 0)
+		index += pack->size;
+
+	if(index < 0 || (unsigned long)index >= pack->size)
+		return(FALSE);
+
+	block = index / INTLIST_PACK_BLOCK;
+	intlist_unpack_block(buffer, pack->data + pack->block[block].offset,
+			intlist_pack_count(pack, block), pack->block + block);
+
+	if(value)
+		*value = buffer[index % INTLIST_PACK_BLOCK];
+
+	return(TRUE);
+}
+
+long IntListPackFind(IntListPackPtr pack, long value)
+{
+	long buffer[INTLIST_PACK_BLOCK];
+	unsigned long block = pack->blocks, n;
+
+	/* Search from the back like IntListFind, skipping blocks by their range */
+	while(block--) {
+		if(value < pack->block[block].base || value > pack->block[block].max)
+			continue;
+
+		n = intlist_pack_count(pack, block);
+		intlist_unpack_block(buffer, pack->data + pack->block[block].offset, n, pack->block + block);
+
+		while(n--)
+			if(buffer[n] == value)
+				return(block * INTLIST_PACK_BLOCK + n);
+	}
+
+	return(-1);
+}
+
+long IntListPackLowerBound(IntListPackPtr pack, long value)
+{
+	long buffer[INTLIST_PACK_BLOCK];
+	unsigned long lo = 0, hi = pack->blocks, mid, n, i;
+
+	/* Sorted input only: the first block whose maximum reaches value */
+	while(lo < hi) {
+		mid = (lo + hi) >> 1;
+		if(pack->block[mid].max < value)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	if(lo >= pack->blocks)
+		return(pack->size);
+
+	n = intlist_pack_count(pack, lo);
+	intlist_unpack_block(buffer, pack->data + pack->block[lo].offset, n, pack->block + lo);
+
+	for(i = 0; i < n && buffer[i] < value; i++);
+
+	return(lo * INTLIST_PACK_BLOCK + i);
+}
+
+int IntListPackIterInit(IntListPackIterPtr iter, IntListPackPtr pack, long index)
+{
+	if(index < 0)
+		index += pack->size;
+
+	if(index < 0 || (unsigned long)index > pack->size)
+		return(FALSE);
+
+	iter->pack = pack;
+	iter->index = index;
+	iter->block = pack->blocks;
+
+	return(TRUE);
+}
+
+int IntListPackNext(IntListPackIterPtr iter, long *value)
+{
+	IntListPackPtr pack = iter->pack;
+	unsigned long block = iter->index / INTLIST_PACK_BLOCK;
+
+	if(iter->index >= pack->size)
+		return(FALSE);
+
+	if(block != iter->block) {
+		intlist_unpack_block(iter->buffer, pack->data + pack->block[block].offset,
+				intlist_pack_count(pack, block), pack->block + block);
+		iter->block = block;
+	}
+
+	if(value)
+		*value = iter->buffer[iter->index % INTLIST_PACK_BLOCK];
+
+	iter->index++;
+
+	return(TRUE);
+}
+
+
+
+/***********************************
+ *  Segmented Int List functions
+ */
+int IntSegListInit(IntSegListPtr list, long block_size)
+{
+	list->block = NULL;
+	list->tree = NULL;
+	list->blocks = 0;
+	list->reserve = 0;
+	list->size = 0;
+	list->block_size = block_size > 1 ? block_size : INTSEG_BLOCK;
+
+	return(TRUE);
+}
+
+void IntSegListFree(IntSegListPtr list)
+{
+	long b;
+
+	for(b = 0; b < list->blocks; b++)
+		lists_buffer_free(list->block[b].data);
+
+	lists_buffer_free(list->block);
+	lists_buffer_free(list->tree);
+
+	list->block = NULL;
+	list->tree = NULL;
+	list->blocks = 0;
+	list->reserve = 0;
+	list->size = 0;
+}
+
+long IntSegListSize(IntSegListPtr list)
+{
+	return(list->size);
+}
+
+/* Rebuilds the Fenwick tree after blocks are split, merged or dropped */
+void intseg_tree_build(IntSegListPtr list)
+{
+	long i, j;
+
+	for(i = 1; i <= list->blocks; i++)
+		list->tree[i] = list->block[i - 1].size;
+
+	for(i = 1; i <= list->blocks; i++)
+		if((j = i + (i & -i)) <= list->blocks)
+			list->tree[j] += list->tree[i];
+}
+
+void intseg_tree_add(IntSegListPtr list, long b, long delta)
+{
+	for(b++; b <= list->blocks; b += b & -b)
+		list->tree[b] += delta;
+}
+
+/* Finds the block holding index (0 <= index < size) and the offset within it */
+long intseg_locate(IntSegListPtr list, long index, long *offset)
+{
+	long b = 0, step = 1;
+
+	while(step * 2 <= list->blocks)
+		step *= 2;
+
+	for(; step; step >>= 1)
+		if(b + step <= list->blocks && list->tree[b + step] <= index) {
+			b += step;
+			index -= list->tree[b];
+		}
+
+	*offset = index;
+
+	return(b);
+}
+
+/* Opens an empty block at position b */
+int intseg_block_insert(IntSegListPtr list, long b)
+{
+	IntSegBlockType *block;
+	long *tree, *data, reserve;
+
+	if(list->blocks >= list->reserve) {
+		reserve = list->reserve ? list->reserve * 2 : 16;
+		if((block = lists_buffer_realloc(list->block, reserve * sizeof(IntSegBlockType))) == NULL)
+			return(FALSE);
+		list->block = block;
+		if((tree = lists_buffer_realloc(list->tree, (reserve + 1) * sizeof(long))) == NULL)
+			return(FALSE);
+		list->tree = tree;
+		list->reserve = reserve;
+	}
+
+	if((data = lists_buffer_realloc(NULL, list->block_size * sizeof(long))) == NULL)
+		return(FALSE);
+
+	memmove(list->block + b + 1, list->block + b, (list->blocks - b) * sizeof(IntSegBlockType));
+	list->block[b].data = data;
+	list->block[b].size = 0;
+	list->blocks++;
+
+	return(TRUE);
+}
+
+void intseg_block_remove(IntSegListPtr list, long b)
+{
+	lists_buffer_free(list->block[b].data);
+	list->blocks--;
+	memmove(list->block + b, list->block + b + 1, (list->blocks - b) * sizeof(IntSegBlockType));
+}
+
+int IntSegListInsert(IntSegListPtr list, long index, long value)
+{
+	IntSegBlockPtr block;
+	long b, offset, half;
+
+	if(index < 0)
+		index += list->size + 1;
+
+	if(index < 0 || index > list->size)
+		return(FALSE);
+
+	if(!list->blocks) {
+		if(!intseg_block_insert(list, 0))
+			return(FALSE);
+		intseg_tree_build(list);
+	}
+
+	if(index == list->size) {
+		b = list->blocks - 1;
+		offset = list->block[b].size;
+	} else
+		b = intseg_locate(list, index, &offset);
+
+	/* A full block splits in two; only its upper half moves */
+	if(list->block[b].size == list->block_size) {
+		if(!intseg_block_insert(list, b + 1))
+			return(FALSE);
+		half = list->block_size / 2;
+		memcpy(list->block[b + 1].data, list->block[b].data + half,
+				(list->block_size - half) * sizeof(long));
+		list->block[b + 1].size = list->block_size - half;
+		list->block[b].size = half;
+		intseg_tree_build(list);
+		if(offset > half) {
+			b++;
+			offset -= half;
+		}
+	}
+
+	block = list->block + b;
+	memmove(block->data + offset + 1, block->data + offset, (block->size - offset) * sizeof(long));
+	block->data[offset] = value;
+	block->size++;
+	list->size++;
+	intseg_tree_add(list, b, 1);
+
+	return(TRUE);
+}
+
+int IntSegListRemove(IntSegListPtr list, long index, unsigned long size)
+{
+	IntSegBlockPtr block;
+	long b, offset, n;
+
+	if(index < 0)
+		index += list->size;
+
+	if(!size || index < 0 || index + size > (unsigned long)list->size)
+		return(FALSE);
+
+	while(size) {
+		b = intseg_locate(list, index, &offset);
+		block = list->block + b;
+		n = block->size - offset < (long)size ? block->size - offset : (long)size;
+
+		memmove(block->data + offset, block->data + offset + n,
+				(block->size - offset - n) * sizeof(long));
+		block->size -= n;
+		list->size -= n;
+		size -= n;
+
+		/* Empty blocks go; sparse neighbours merge into one */
+		if(!block->size)
+			intseg_block_remove(list, b);
+		else if(b + 1 < list->blocks && block->size + block[1].size <= list->block_size / 2) {
+			memcpy(block->data + block->size, block[1].data, block[1].size * sizeof(long));
+			block->size += block[1].size;
+			intseg_block_remove(list, b + 1);
+		} else if(b > 0 && block->size + block[-1].size <= list->block_size / 2) {
+			memcpy(block[-1].data + block[-1].size, block->data, block->size * sizeof(long));
+			block[-1].size += block->size;
+			intseg_block_remove(list, b);
+		} else {
+			intseg_tree_add(list, b, -n);
+			continue;
+		}
+
+		intseg_tree_build(list);
+	}
+
+	return(TRUE);
+}
+
+int IntSegListPush(IntSegListPtr list, long value)
+{
+	return(IntSegListInsert(list, list->size, value));
+}
+
+int IntSegListPop(IntSegListPtr list, long *value)
+{
+	if(!IntSegListGet(list, -1, value))
+		return(FALSE);
+
+	return(IntSegListRemove(list, -1, 1));
+}
+
+long *intseg_index(IntSegListPtr list, long index)
+{
+	long b, offset;
+
+	if(index < 0)
+		index += list->size;
+
+	if(index < 0 || index >= list->size)
+		return(NULL);
+
+	b = intseg_locate(list, index, &offset);
+
+	return(list->block[b].data + offset);
+}
+
+int IntSegListSet(IntSegListPtr list, long index, long value)
+{
+	long *ptr;
+
+	if(!(ptr = intseg_index(list, index)))
+		return(FALSE);
+
+	*ptr = value;
+
+	return(TRUE);
+}
+
+int IntSegListGet(IntSegListPtr list, long index, long *value)
+{
+	long *ptr;
+
+	if(!(ptr = intseg_index(list, index)))
+		return(FALSE);
+
+	if(value)
+		*value = *ptr;
+
+	return(TRUE);
+}
+
+long IntSegListFind(IntSegListPtr list, long value)
+{
+	long b = list->blocks, start = list->size, n;
+
+	while(--b >= 0) {
+		start -= list->block[b].size;
+		for(n = list->block[b].size; --n >= 0;)
+			if(list->block[b].data[n] == value)
+				return(start + n);
+	}
+
+	return(-1);
+}
+
+int IntSegListMap(IntSegListPtr list, IntSegListMapFunc map_func, void *custom)
+{
+	long b, n, index = 0;
+
+	for(b = 0; b < list->blocks; b++)
+		for(n = 0; n < list->block[b].size; n++, index++)
+			list->block[b].data[n] = map_func(list, index, list->block[b].data[n], custom);
+
+	return(TRUE);
+}
+
+int IntSegListReduce(IntSegListPtr list, IntSegListReduceFunc reduce_func, long *value, long initial, void *custom)
+{
+	long b = list->blocks, n;
+
+	while(--b >= 0)
+		for(n = list->block[b].size; --n >= 0;)
+			initial = reduce_func(list, initial, list->block[b].data[n], custom);
+
+	if(value)
+		*value = initial;
+
+	return(TRUE);
+}
+
+
+/**********************************
+ *  Int List window functions
+ */
+
+/* Back of a monotonic deque (a ring of sequence numbers) */
+#define intwindow_back(window, deque, count)	(deque)[((count) - 1) % (window)->capacity]
+
+int IntListWindowInit(IntListWindowPtr window, unsigned long capacity)
+{
+	window->value = NULL;
+	window->min = window->max = NULL;
+	window->capacity = window->count = window->pushed = 0;
+	window->min_first = window->min_last = window->max_first = window->max_last = 0;
+	window->sum = 0;
+
+	if(!capacity)
+		return(FALSE);
+
+	window->value = lists_malloc(capacity * sizeof(long));
+	window->min = lists_malloc(capacity * sizeof(unsigned long));
+	window->max = lists_malloc(capacity * sizeof(unsigned long));
+	if(!window->value || !window->min || !window->max) {
+		IntListWindowFree(window);
+		return(FALSE);
+	}
+
+	window->capacity = capacity;
+
+	return(TRUE);
+}
+
+void IntListWindowFree(IntListWindowPtr window)
+{
+	lists_free(window->value);
+	lists_free(window->min);
+	lists_free(window->max);
+
+	window->value = NULL;
+	window->min = window->max = NULL;
+	window->capacity = window->count = window->pushed = 0;
+	window->min_first = window->min_last = window->max_first = window->max_last = 0;
+	window->sum = 0;
+}
+
+/* Drops the oldest element; the deques only ever hold it at their fronts */
+int IntListWindowEvict(IntListWindowPtr window, long *value)
+{
+	unsigned long seq;
+	long oldest;
+
+	if(!window->count)
+		return(FALSE);
+
+	seq = window->pushed - window->count;
+	oldest = window->value[seq % window->capacity];
+
+	if(window->min[window->min_first % window->capacity] == seq)
+		window->min_first++;
+	if(window->max[window->max_first % window->capacity] == seq)
+		window->max_first++;
+
+	window->sum -= oldest;
+	window->count--;
+
+	if(value)
+		*value = oldest;
+
+	return(TRUE);
+}
+
+/* Adds a value, evicting the oldest one first when the window is full */
+int IntListWindowPush(IntListWindowPtr window, long value)
+{
+	unsigned long seq = window->pushed;
+
+	if(!window->capacity)
+		return(FALSE);
+
+	if(window->count == window->capacity)
+		IntListWindowEvict(window, NULL);
+
+	/* Values that can never be the min (or max) again leave from the back */
+	while(window->min_last > window->min_first
+			&& window->value[intwindow_back(window, window->min, window->min_last) % window->capacity] >= value)
+		window->min_last--;
+	while(window->max_last > window->max_first
+			&& window->value[intwindow_back(window, window->max, window->max_last) % window->capacity] <= value)
+		window->max_last--;
+
+	window->value[seq % window->capacity] = value;
+	window->min[window->min_last++ % window->capacity] = seq;
+	window->max[window->max_last++ % window->capacity] = seq;
+
+	window->sum += value;
+	window->count++;
+	window->pushed++;
+
+	return(TRUE);
+}
+
+unsigned long IntListWindowCount(IntListWindowPtr window)
+{
+	return(window->count);
+}
+
+long IntListWindowSum(IntListWindowPtr window)
+{
+	return(window->sum);
+}
+
+int IntListWindowMin(IntListWindowPtr window, long *value)
+{
+	if(!window->count)
+		return(FALSE);
+
+	if(value)
+		*value = window->value[window->min[window->min_first % window->capacity] % window->capacity];
+
+	return(TRUE);
+}
+
+int IntListWindowMax(IntListWindowPtr window, long *value)
+{
+	if(!window->count)
+		return(FALSE);
+
+	if(value)
+		*value = window->value[window->max[window->max_first % window->capacity] % window->capacity];
+
+	return(TRUE);
+}
+
+/* Index 0 is the oldest element, negative indices count back from the newest */
+int IntListWindowGet(IntListWindowPtr window, long index, long *value)
+{
+	if(index < 0)
+		index += window->count;
+
+	if(index < 0 || (unsigned long)index >= window->count)
+		return(FALSE);
+
+	if(value)
+		*value = window->value[(window->pushed - window->count + index) % window->capacity];
+
+	return(TRUE);
+}
+
+
+/***********************
+ *  Bitmap functions
+ */
+#define BITMAP_WORDS	1024	/* 64-bit words in a bits container */
+
+int lists_popcount(uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return(__builtin_popcountll(x));
+#else
+	x = x - ((x >> 1) & 0x5555555555555555ULL);
+	x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+	x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+
+	return((int)((x * 0x0101010101010101ULL) >> 56));
+#endif
+}
+
+int lists_ctz(uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return(__builtin_ctzll(x));
+#else
+	return(lists_popcount((x & -x) - 1));
+#endif
+}
+
+int BitmapInit(BitmapPtr bitmap)
+{
+	bitmap->container = NULL;
+	bitmap->size = 0;
+	bitmap->reserve = 0;
+
+	return(TRUE);
+}
+
+void BitmapFree(BitmapPtr bitmap)
+{
+	unsigned long i;
+
+	for(i = 0; i < bitmap->size; i++)
+		lists_free(bitmap->container[i].data);
+
+	lists_free(bitmap->container);
+	BitmapInit(bitmap);
+}
+
+/* Containers by key, or the position a new one would go, as -1 - position */
+long bitmap_find(BitmapPtr bitmap, long key)
+{
+	long lo = 0, hi = bitmap->size, mid;
+
+	while(lo < hi) {
+		mid = (lo + hi) >> 1;
+		if(bitmap->container[mid].key < key)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	if((unsigned long)lo < bitmap->size && bitmap->container[lo].key == key)
+		return(lo);
+
+	return(-1 - lo);
+}
+
+BitmapContainerPtr bitmap_insert(BitmapPtr bitmap, unsigned long position, long key)
+{
+	BitmapContainerPtr container;
+	unsigned long reserve;
+
+	if(bitmap->size >= bitmap->reserve) {
+		reserve = bitmap->reserve ? bitmap->reserve * 2 : 16;
+		if((container = lists_realloc(bitmap->container, reserve * sizeof(BitmapContainerType))) == NULL)
+			return(NULL);
+		bitmap->container = container;
+		bitmap->reserve = reserve;
+	}
+
+	container = bitmap->container + position;
+	memmove(container + 1, container, (bitmap->size - position) * sizeof(BitmapContainerType));
+	bitmap->size++;
+
+	container->key = key;
+	container->type = BITMAP_ARRAY;
+	container->size = 0;
+	container->reserve = 0;
+	container->data = NULL;
+
+	return(container);
+}
+
+unsigned long bitmap_card(BitmapContainerPtr container)
+{
+	uint16_t *run = container->data;
+	unsigned long i, card = 0;
+
+	if(container->type != BITMAP_RUN)
+		return(container->size);
+
+	for(i = 0; i < container->size; i++)
+		card += run[i * 2 + 1] + 1UL;
+
+	return(card);
+}
+
+int bitmap_has(BitmapContainerPtr container, unsigned int low)
+{
+	uint16_t *data = container->data;
+	long lo = 0, hi = container->size, mid;
+
+	if(container->type == BITMAP_BITS)
+		return((((uint64_t *)data)[low >> 6] >> (low & 63)) & 1);
+
+	if(container->type == BITMAP_ARRAY) {
+		while(lo < hi) {
+			mid = (lo + hi) >> 1;
+			if(data[mid] < low)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		return((unsigned long)lo < container->size && data[lo] == low);
+	}
+
+	/* Runs are (start, length - 1) pairs: find the last starting at or below low */
+	while(lo < hi) {
+		mid = (lo + hi) >> 1;
+		if(data[mid * 2] <= low)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return(lo && low - data[(lo - 1) * 2] <= data[(lo - 1) * 2 + 1]);
+}
+
+/* Rewrites any container as bits */
+int bitmap_to_bits(BitmapContainerPtr container)
+{
+	uint16_t *data = container->data;
+	uint64_t *bits;
+	unsigned long i, v, card;
+
+	if(container->type == BITMAP_BITS)
+		return(TRUE);
+
+	if((bits = lists_calloc(BITMAP_WORDS, sizeof(uint64_t))) == NULL)
+		return(FALSE);
+
+	card = bitmap_card(container);
+	if(container->type == BITMAP_ARRAY)
+		for(i = 0; i < container->size; i++)
+			bits[data[i] >> 6] |= 1ULL << (data[i] & 63);
+	else
+		for(i = 0; i < container->size; i++)
+			for(v = data[i * 2]; v <= (unsigned long)data[i * 2] + data[i * 2 + 1]; v++)
+				bits[v >> 6] |= 1ULL << (v & 63);
+
+	lists_free(data);
+	container->data = bits;
+	container->type = BITMAP_BITS;
+	container->size = card;
+	container->reserve = 0;
+
+	return(TRUE);
+}
+
+/* Rewrites any container as a sorted array, however large */
+int bitmap_to_array(BitmapContainerPtr container)
+{
+	uint16_t *data = container->data, *array;
+	uint64_t word;
+	unsigned long i, v, n = 0, card = bitmap_card(container);
+
+	if(container->type == BITMAP_ARRAY)
+		return(TRUE);
+
+	if((array = lists_malloc((card ? card : 1) * sizeof(uint16_t))) == NULL)
+		return(FALSE);
+
+	if(container->type == BITMAP_BITS)
+		for(i = 0; i < BITMAP_WORDS; i++)
+			for(word = ((uint64_t *)data)[i]; word; word &= word - 1)
+				array[n++] = i * 64 + lists_ctz(word);
+	else
+		for(i = 0; i < container->size; i++)
+			for(v = data[i * 2]; v <= (unsigned long)data[i * 2] + data[i * 2 + 1]; v++)
+				array[n++] = v;
+
+	lists_free(data);
+	container->data = array;
+	container->type = BITMAP_ARRAY;
+	container->size = card;
+	container->reserve = card;
+
+	return(TRUE);
+}
+
+/* Runs go back to whichever of array or bits suits their cardinality */
+int bitmap_unpack(BitmapContainerPtr container)
+{
+	if(container->type != BITMAP_RUN)
+		return(TRUE);
+
+	if(bitmap_card(container) > BITMAP_ARRAY_MAX)
+		return(bitmap_to_bits(container));
+
+	return(bitmap_to_array(container));
+}
+
+int BitmapAdd(BitmapPtr bitmap, long value)
+{
+	BitmapContainerPtr container;
+	unsigned int low = value & 0xffff;
+	long position = bitmap_find(bitmap, value >> 16), lo = 0, hi;
+	uint16_t *data;
+	unsigned long reserve;
+
+	if(position < 0) {
+		if((container = bitmap_insert(bitmap, -1 - position, value >> 16)) == NULL)
+			return(FALSE);
+	} else
+		container = bitmap->container + position;
+
+	if(bitmap_has(container, low))
+		return(TRUE);
+
+	if(!bitmap_unpack(container))
+		return(FALSE);
+
+	if(container->type == BITMAP_ARRAY && container->size >= BITMAP_ARRAY_MAX)
+		if(!bitmap_to_bits(container))
+			return(FALSE);
+
+	if(container->type == BITMAP_BITS) {
+		((uint64_t *)container->data)[low >> 6] |= 1ULL << (low & 63);
+		container->size++;
+		return(TRUE);
+	}
+
+	if(container->size >= container->reserve) {
+		reserve = container->reserve ? container->reserve * 2 : 4;
+		if((data = lists_realloc(container->data, reserve * sizeof(uint16_t))) == NULL)
+			return(FALSE);
+		container->data = data;
+		container->reserve = reserve;
+	}
+
+	data = container->data;
+	for(hi = container->size; lo < hi;)
+		if(data[(lo + hi) >> 1] < low)
+			lo = ((lo + hi) >> 1) + 1;
+		else
+			hi = (lo + hi) >> 1;
+	memmove(data + lo + 1, data + lo, (container->size - lo) * sizeof(uint16_t));
+	data[lo] = low;
+	container->size++;
+
+	return(TRUE);
+}
+
+int BitmapContains(BitmapPtr bitmap, long value)
+{
+	long position;
+
+	/* A single container needs no search */
+	if(bitmap->size == 1)
+		position = bitmap->container->key == value >> 16 ? 0 : -1;
+	else
+		position = bitmap_find(bitmap, value >> 16);
+
+	return(position >= 0 && bitmap_has(bitmap->container + position, value & 0xffff));
+}
+
+unsigned long BitmapCardinality(BitmapPtr bitmap)
+{
+	unsigned long i, card = 0;
+
+	for(i = 0; i < bitmap->size; i++)
+		card += bitmap_card(bitmap->container + i);
+
+	return(card);
+}
+
+unsigned long BitmapBytes(BitmapPtr bitmap)
+{
+	BitmapContainerPtr container;
+	unsigned long i, bytes = bitmap->reserve * sizeof(BitmapContainerType);
+
+	for(i = 0; i < bitmap->size; i++) {
+		container = bitmap->container + i;
+		if(container->type == BITMAP_BITS)
+			bytes += BITMAP_WORDS * sizeof(uint64_t);
+		else if(container->type == BITMAP_RUN)
+			bytes += container->size * 2 * sizeof(uint16_t);
+		else
+			bytes += container->reserve * sizeof(uint16_t);
+	}
+
+	return(bytes);
+}
+
+/* Copies a source container, unpacking runs so the set operations see arrays or bits */
+int bitmap_copy(BitmapContainerPtr dest, BitmapContainerPtr src)
+{
+	size_t bytes = src->type == BITMAP_BITS ? BITMAP_WORDS * sizeof(uint64_t)
+			: src->size * (src->type == BITMAP_RUN ? 2 : 1) * sizeof(uint16_t);
+
+	*dest = *src;
+	if((dest->data = lists_malloc(bytes ? bytes : 1)) == NULL)
+		return(FALSE);
+	memcpy(dest->data, src->data, bytes);
+	dest->reserve = src->type == BITMAP_ARRAY ? src->size : 0;
+
+	if(!bitmap_unpack(dest)) {
+		lists_free(dest->data);
+		return(FALSE);
+	}
+
+	return(TRUE);
+}
+
+/* Recounts a bits container, shrinking it to an array once it fits one again */
+int bitmap_settle(BitmapContainerPtr container)
+{
+	uint64_t *bits = container->data;
+	unsigned long i, card = 0;
+
+	if(container->type != BITMAP_BITS)
+		return(TRUE);
+
+	for(i = 0; i < BITMAP_WORDS; i++)
+		card += lists_popcount(bits[i]);
+	container->size = card;
+
+	return(card > BITMAP_ARRAY_MAX || bitmap_to_array(container));
+}
+
+/* x and y are unpacked copies, consumed here; the result, possibly empty, lands in x */
+int bitmap_union(BitmapContainerPtr x, BitmapContainerPtr y)
+{
+	uint16_t *a = x->data, *b = y->data, *out;
+	uint64_t *bits;
+	unsigned long i = 0, j = 0, k = 0;
+
+	if(x->type == BITMAP_ARRAY && y->type == BITMAP_ARRAY && x->size + y->size <= BITMAP_ARRAY_MAX) {
+		if((out = lists_malloc((x->size + y->size + 1) * sizeof(uint16_t))) == NULL)
+			return(FALSE);
+		while(i < x->size && j < y->size)
+			if(a[i] < b[j])
+				out[k++] = a[i++];
+			else if(b[j] < a[i])
+				out[k++] = b[j++];
+			else {
+				out[k++] = a[i++];
+				j++;
+			}
+		while(i < x->size)
+			out[k++] = a[i++];
+		while(j < y->size)
+			out[k++] = b[j++];
+		lists_free(a);
+		lists_free(b);
+		x->data = out;
+		x->size = x->reserve = k;
+		return(TRUE);
+	}
+
+	if(!bitmap_to_bits(x) || !bitmap_to_bits(y)) {
+		lists_free(x->data);
+		lists_free(y->data);
+		return(FALSE);
+	}
+
+	/* Word-wise OR over fixed 1024-word blocks, which compilers vectorize */
+	bits = x->data;
+	for(i = 0; i < BITMAP_WORDS; i++)
+		bits[i] |= ((uint64_t *)y->data)[i];
+	lists_free(y->data);
+
+	return(bitmap_settle(x));
+}
+
+int bitmap_intersect(BitmapContainerPtr x, BitmapContainerPtr y)
+{
+	BitmapContainerType tmp;
+	uint16_t *a, *b;
+	uint64_t *bits;
+	unsigned long i = 0, j = 0, k = 0;
+
+	if(x->type == BITMAP_BITS && y->type == BITMAP_ARRAY) {
+		tmp = *x;
+		*x = *y;
+		*y = tmp;
+	}
+
+	a = x->data;
+	b = y->data;
+
+	if(x->type == BITMAP_ARRAY && y->type == BITMAP_ARRAY) {
+		while(i < x->size && j < y->size) {
+			a[k] = a[i];
+			k += a[i] == b[j];
+			if(a[i] <= b[j])
+				i++;
+			else
+				j++;
+		}
+		x->size = k;
+	} else if(x->type == BITMAP_ARRAY) {
+		for(; i < x->size; i++) {
+			a[k] = a[i];
+			k += (((uint64_t *)b)[a[i] >> 6] >> (a[i] & 63)) & 1;
+		}
+		x->size = k;
+	} else {
+		bits = x->data;
+		for(i = 0; i < BITMAP_WORDS; i++)
+			bits[i] &= ((uint64_t *)b)[i];
+	}
+
+	lists_free(y->data);
+
+	return(bitmap_settle(x));
+}
+
+int bitmap_merge(BitmapPtr dest, BitmapPtr a, BitmapPtr b, int intersect)
+{
+	BitmapContainerType x, y;
+	BitmapContainerPtr container;
+	unsigned long i = 0, j = 0;
+	int ok;
+
+	BitmapFree(dest);
+
+	while(i < a->size || j < b->size) {
+		if(j >= b->size || (i < a->size && a->container[i].key < b->container[j].key)) {
+			if(intersect) {
+				i++;
+				continue;
+			}
+			ok = bitmap_copy(&x, a->container + i++);
+		} else if(i >= a->size || b->container[j].key < a->container[i].key) {
+			if(intersect) {
+				j++;
+				continue;
+			}
+			ok = bitmap_copy(&x, b->container + j++);
+		} else {
+			if(!bitmap_copy(&x, a->container + i++))
+				return(FALSE);
+			if(!bitmap_copy(&y, b->container + j++)) {
+				lists_free(x.data);
+				return(FALSE);
+			}
+			ok = intersect ? bitmap_intersect(&x, &y) : bitmap_union(&x, &y);
+		}
+
+		if(!ok)
+			return(FALSE);
+
+		if(!x.size) {
+			lists_free(x.data);
+			continue;
+		}
+
+		if((container = bitmap_insert(dest, dest->size, x.key)) == NULL) {
+			lists_free(x.data);
+			return(FALSE);
+		}
+		*container = x;
+	}
+
+	return(TRUE);
+}
+
+int BitmapUnion(BitmapPtr dest, BitmapPtr a, BitmapPtr b)
+{
+	return(bitmap_merge(dest, a, b, FALSE));
+}
+
+int BitmapIntersect(BitmapPtr dest, BitmapPtr a, BitmapPtr b)
+{
+	return(bitmap_merge(dest, a, b, TRUE));
+}
+
+/* Picks the smallest of array, bits or runs for each container */
+int BitmapOptimize(BitmapPtr bitmap)
+{
+	BitmapContainerPtr container;
+	uint16_t *run, *array;
+	unsigned long i, n, runs, card;
+
+	for(i = 0; i < bitmap->size; i++) {
+		container = bitmap->container + i;
+		if(!bitmap_unpack(container) || !bitmap_to_array(container))
+			return(FALSE);
+
+		array = container->data;
+		card = container->size;
+		for(n = 1, runs = card ? 1 : 0; n < card; n++)
+			runs += array[n] != array[n - 1] + 1;
+
+		if(runs * 2 < (card < BITMAP_ARRAY_MAX ? card : BITMAP_ARRAY_MAX)) {
+			if((run = lists_malloc(runs * 2 * sizeof(uint16_t))) == NULL)
+				return(FALSE);
+			for(n = 0, runs = 0; n < card; n++)
+				if(!n || array[n] != array[n - 1] + 1) {
+					run[runs * 2] = array[n];
+					run[runs++ * 2 + 1] = 0;
+				} else
+					run[runs * 2 - 1]++;
+			lists_free(array);
+			container->data = run;
+			container->type = BITMAP_RUN;
+			container->size = runs;
+			container->reserve = 0;
+		} else if(card > BITMAP_ARRAY_MAX) {
+			if(!bitmap_to_bits(container))
+				return(FALSE);
+		}
+	}
+
+	return(TRUE);
+}
+
+int IntListToBitmap(BitmapPtr bitmap, IntListPtr list)
+{
+	unsigned long i, size = intlist_size(list), n, start;
+	long *longs, *tmp, *sorted;
+	BitmapContainerPtr container;
+	uint16_t *array;
+
+	BitmapFree(bitmap);
+
+	if((longs = intlist_longs(list, &tmp)) == NULL)
+		return(FALSE);
+
+	/* Work on a sorted copy so each container is filled in one pass */
+	if(!tmp) {
+		if((sorted = lists_malloc((size ? size : 1) * sizeof(long))) == NULL)
+			return(FALSE);
+		memcpy(sorted, longs, size * sizeof(long));
+	} else
+		sorted = tmp;
+	qsort(sorted, size, sizeof(long), lists_qsort_long);
+
+	for(i = 0; i < size; i = n) {
+		for(start = i, n = i + 1; n < size && sorted[n] >> 16 == sorted[start] >> 16; n++);
+
+		if((container = bitmap_insert(bitmap, bitmap->size, sorted[start] >> 16)) == NULL
+				|| (array = lists_malloc((n - start) * sizeof(uint16_t))) == NULL) {
+			lists_free(sorted);
+			return(FALSE);
+		}
+
+		container->data = array;
+		for(; start < n; start++)
+			if(!container->size || array[container->size - 1] != (sorted[start] & 0xffff))
+				array[container->size++] = sorted[start] & 0xffff;
+		container->reserve = n - i;
+
+		if(container->size > BITMAP_ARRAY_MAX && !bitmap_to_bits(container)) {
+			lists_free(sorted);
+			return(FALSE);
+		}
+	}
+
+	lists_free(sorted);
+
+	return(TRUE);
+}
+
+int BitmapToIntList(IntListPtr list, BitmapPtr bitmap)
+{
+	BitmapContainerPtr container;
+	uint16_t *data;
+	uint64_t word;
+	unsigned long i, j, v;
+	long *out, base;
+
+	if((out = intlist_set_dest(list, BitmapCardinality(bitmap))) == NULL)
+		return(FALSE);
+
+	for(i = 0; i < bitmap->size; i++) {
+		container = bitmap->container + i;
+		data = container->data;
+		base = container->key * 65536;
+
+		if(container->type == BITMAP_ARRAY)
+			for(j = 0; j < container->size; j++)
+				*out++ = base + data[j];
+		else if(container->type == BITMAP_BITS)
+			for(j = 0; j < BITMAP_WORDS; j++)
+				for(word = ((uint64_t *)data)[j]; word; word &= word - 1)
+					*out++ = base + j * 64 + lists_ctz(word);
+		else
+			for(j = 0; j < container->size; j++)
+				for(v = data[j * 2]; v <= (unsigned long)data[j * 2] + data[j * 2 + 1]; v++)
+					*out++ = base + v;
+	}
+
+	list->ptr = out;
+
+	return(TRUE);
+}
+
+
+/************************
+ *  Void List functions
+ */
+int VoidListInit(VoidListPtr list, long reserve, long grow, size_t width,
+		VoidListAllocFunc alloc_func, VoidListFreeFunc free_func,
+		VoidListCpyFunc cpy_func, VoidListCmpFunc cmp_func)
+{
+	list->start = list->ptr = NULL;
+	list->reserve = list->grow = 0;
+	list->budget = 0;
+
+	if(reserve && (list->start = list->ptr = lists_buffer_realloc(NULL, reserve * sizeof(void *))) == NULL)
+		return(FALSE);
+
+	list->reserve = reserve;
+	list->grow = grow;
+	list->width = width;
+	list->alloc_func = alloc_func ? alloc_func : voidlist_alloc;
+	list->free_func = free_func ? free_func : voidlist_free;
+	list->cpy_func = cpy_func ? cpy_func : voidlist_cpy;
+	list->cmp_func = cmp_func ? cmp_func : voidlist_cmp;
+	list->free_block_func = NULL;
+	list->custom = NULL;
+
+	return(TRUE);
+}
+
+/* Releases a run of elements in one call when the list has a block free callback */
+long voidlist_free_block(VoidListPtr list, void **ptr, long size)
+{
+	if(list->free_block_func)
+		list->free_block_func(list, ptr, size);
+	else
+		while(size--)
+			list->free_func(list, *ptr++);
+
+	return(0);
+}
+
+void VoidListFree(VoidListPtr list)
+{
+	if(lists_register_count)
+		ListsUnregister(list);
+
+	if(list->free_func) {
+		voidlist_free_block(list, list->start, list->ptr - list->start);
+		list->ptr = list->start;
+
+		lists_buffer_free(list->start);
+		list->start = NULL;
+	}
+
+	list->reserve = 0;
+	list->grow = 0;
+	list->width = 0;
+	list->alloc_func = NULL;
+	list->free_func = NULL;
+	list->cpy_func = NULL;
+	list->cmp_func = NULL;
+	list->free_block_func = NULL;
+	list->custom = NULL;
+	list->budget = 0;
+}
+
+void _VoidListDump(VoidListPtr list, FILE *stream, int type, char *name)
+{
+	if(type) {
+		fprintf(stream, "%s[0x%p]\n", name, list);
+		fprintf(stream, " |--Start: 0x%p\n", list->start);
+		fprintf(stream, " |--Pointer: 0x%p(+%zu)\n", list->ptr, list->ptr - list->start);
+		fprintf(stream, " |--Reserve: %lu units\n", list->reserve);
+		fprintf(stream, " |--Grow: +%lu units\n\n", list->grow);
+		fprintf(stream, " +--Width: +%zu bytes\n\n", list->width);
+	} else
+		fprintf(stream, "%s[0x%p] Data: [0x%p:+%zu], Reserve [%lu:+%lu], Width [%zu b.]\n",
+				name, list, list->start, list->ptr - list->start,
+				list->reserve, list->grow, list->width);
+}
+
+void VoidListDump(VoidListPtr list, FILE *stream, int type)
+{
+	_VoidListDump(list, stream, type, "Void List");
+}
+
+void *voidlist_print(VoidListPtr list, long index, void *value, void *custom)
+{
+	fprintf(custom, "0x%p ", value);
+	return(value);
+}
+
+void VoidListPrint(VoidListPtr list, FILE *stream, VoidListMapFunc func)
+{
+	fprintf(stream, "[ ");
+	VoidListMap(list, func ? func : voidlist_print, stream);
+	fprintf(stream, "]\n");
+}
+
+int voidlist_reserve(VoidListPtr list, unsigned long size, unsigned long grow, size_t width)
+{
+	unsigned long index = list->ptr - list->start, limit, wanted;
+	void **ptr;
+
+	if(!size)
+		size = index;
+
+	if(grow)
+		list->grow = grow;
+
+	if(size < index)
+		size = index;
+
+	wanted = size;
+	size = (size / list->grow + 1) * list->grow;
+
+	if(size < list->grow)
+		size = list->grow;
+
+	if(size > (limit = lists_buffer_limit(list->start) / sizeof(void *)))
+		size = limit;
+
+	if(list->budget && size > (limit = list->budget / sizeof(void *)))
+		size = limit;
+
+	if(size < wanted)
+		return(FALSE);
+
+	if((ptr = lists_buffer_realloc(list->start, size * sizeof(void *))) == NULL)
+		return(FALSE);
+
+	list->start = ptr;
+	list->ptr = ptr + index;
+	list->reserve = size;
+	if(width)
+		list->width = width;
+
+	return(TRUE);
+}
+
+int VoidListReserve(VoidListPtr list, unsigned long size, unsigned long grow, size_t width)
+{
+	unsigned long start = lists_trace_start(), before = list->reserve * sizeof(void *);
+	int result = voidlist_reserve(list, size, grow, width);
+
+	LISTS_PROBE3(reserve, list, before, list->reserve * sizeof(void *));
+	lists_trace_stop(LISTS_OP_RESERVE, start);
+
+	return(result);
+}
+
+int VoidListReserveAddress(VoidListPtr list, unsigned long size)
+{
+#ifdef LISTS_MMAP
+	unsigned long index = list->ptr - list->start;
+	void **ptr;
+
+	if(index > size)
+		return(FALSE);
+
+	if((ptr = lists_buffer_reserve(list->start, size * sizeof(void *))) == NULL)
+		return(FALSE);
+
+	list->start = ptr;
+	list->ptr = ptr + index;
+
+	return(TRUE);
+#else
+	return(FALSE);
+#endif
+}
+
+int VoidListSetBudget(VoidListPtr list, size_t bytes)
+{
+	list->budget = bytes;
+
+	return(!bytes || list->reserve * sizeof(void *) <= bytes);
+}
+
+size_t VoidListBytes(VoidListPtr list)
+{
+	return(list->start ? lists_block(list->start)->size : 0);
+}
+
+int VoidListTrim(VoidListPtr list)
+{
+	unsigned long index = list->ptr - list->start;
+	void **ptr;
+
+	if(!list->start || list->reserve == index)
+		return(TRUE);
+
+	if((ptr = lists_buffer_realloc(list->start, index * sizeof(void *))) == NULL)
+		return(FALSE);
+
+	list->start = ptr;
+	list->ptr = ptr + index;
+	list->reserve = index;
+
+	return(TRUE);
+}
+
+int VoidListRegister(VoidListPtr list)
+{
+	return(lists_register(list, LISTS_REGISTER_VOID));
+}
+
+long VoidListSize(VoidListPtr list)
+{
+	return(list->ptr - list->start);
+}
+
+int voidlist_remove(VoidListPtr list, long index, long size)
+{
+	void **dest = list->start + index, **src = dest + size;
+
+	if(!size || src > list->ptr)
+		return(FALSE);
+
+	voidlist_free_block(list, dest, size);
+
+	if(src < list->ptr)
+		memmove(dest, src, (list->ptr - src) * sizeof(void *));
+
+	list->ptr -= size;
+
+	VoidListReserve(list, index + size, 0, 0);
+
+	return(TRUE);
+}
+
+int VoidListRemove(VoidListPtr list, long index, long size)
+{
+	unsigned long start = lists_trace_start(), moved = (list->ptr - list->start) - index - size;
+	int result = voidlist_remove(list, index, size);
+
+	LISTS_PROBE4(remove, list, index, size, result ? moved * sizeof(void *) : 0);
+	lists_trace_stop(LISTS_OP_REMOVE, start);
+
+	return(result);
+}
+
+int VoidListResize(VoidListPtr list, unsigned long size, void *value, size_t width)
+{
+	unsigned long index = list->ptr - list->start;
+	void **ptr;
+
+	if(size == index)
+		return(TRUE);
+
+	if(size < index)
+		return(VoidListRemove(list, size, index - size));
+
+	VoidListReserve(list, size, 0, 0);
+	ptr = list->start + size;
+	while(list->ptr < ptr)
+		list->alloc_func(list, list->ptr++, value, width ? width : list->width);
+
+	return(TRUE);
+}
+
+/* Uninitialised element storage, freed later through the list's free_func */
+void *VoidListEmplace(VoidListPtr list, size_t width)
+{
+	if(list->ptr >= list->start + list->reserve)
+		if(!VoidListReserve(list, list->reserve, 0, 0) || list->ptr >= list->start + list->reserve)
+			return NULL;
+
+	if((*list->ptr = lists_malloc(width ? width : list->width)) == NULL)
+		return NULL;
+
+	return *list->ptr++;
+}
+
+/* Takes ownership of value as it is, without alloc_func or cpy_func */
+void *VoidListPushNoCopy(VoidListPtr list, void *value)
+{
+	if(list->ptr >= list->start + list->reserve)
+		if(!VoidListReserve(list, list->reserve, 0, 0) || list->ptr >= list->start + list->reserve)
+			return NULL;
+
+	return *list->ptr++ = value;
+}
+
+void *VoidListPush(VoidListPtr list, void *value, size_t width)
+{
+	if(list->ptr >= list->start + list->reserve)
+		if(!VoidListReserve(list, list->reserve, 0, 0) || list->ptr >= list->start + list->reserve)
+			return NULL;
+
+	if(!list->alloc_func(list, list->ptr, value, width ? width : list->width))
+		return NULL;
+
+	return *list->ptr++;
+}
+
+void *VoidListPop(VoidListPtr list, void *value, size_t width)
+{
+	unsigned long size;
+
+	if(list->ptr <= list->start)
+		return NULL;
+
+	list->ptr--;
+
+	if(value)
+		list->cpy_func(list, value, *list->ptr, width ? width : list->width);
+
+	list->free_func(list, *list->ptr);
+
+	if(list->reserve - (list->grow << 1) >= (size = list->ptr - list->start))
+		VoidListReserve(list, size, 0, 0);
+
+	return value;
+}
+
+void **VoidListPointer(VoidListPtr list, long index)
+{
+	void **ptr = (index < 0 ? list->ptr : list->start) + index;
+
+	if(ptr < list->start || ptr >= list->ptr)
+		return(NULL);
+
+	return(ptr);
+}
+
+int VoidListSet(VoidListPtr list, long index, void *value, size_t width)
+{
+	void **ptr;
+
+	if(!(ptr = VoidListPointer(list, index)))
+		return(FALSE);
+
+	list->free_func(list, *ptr);
+	list->alloc_func(list, ptr, value, width ? width : list->width);
+
+	return(TRUE);
+}
+
+int VoidListGet(VoidListPtr list, long index, void *value, size_t width)
+{
+	void **ptr;
+
+	if(!(ptr = VoidListPointer(list, index)))
+		return(FALSE);
+
+	if(value)
+		list->cpy_func(list, value, *ptr, width ? width : list->width);
+
+	return(TRUE);
+}
+
+long VoidListFind(VoidListPtr list, void *value, size_t width)
+{
+	unsigned long index = list->ptr - list->start, distance = lists_prefetch;
+
+	while(index--) {
+		if(distance && index >= distance)
+			lists_prefetch_addr(list->start[index - distance]);
+		if(!list->cmp_func(list, list->start[index], value, width ? width : list->width))
+			return(index);
+	}
+
+	return(-1);
+}
+
+int VoidListReverse(VoidListPtr list, long index, unsigned long size)
+{
+	void *tmp, **ptr[2];
+	unsigned long list_size = list->ptr - list->start;
+
+	if(!list_size || index + size > list_size)
+		return(FALSE);
+
+	if(!size)
+		size = list_size - index;
+
+	if(size < 2)
+		return(TRUE);
+
+	if(!(ptr[0] = VoidListPointer(list, index)))
+		return(FALSE);
+
+	ptr[1] = ptr[0] + size - 1;
+
+	while(ptr[0] < ptr[1]) {
+		memcpy(&tmp, ptr[1], sizeof(void *));
+		memcpy(ptr[1], ptr[0], sizeof(void *));
+		memcpy(ptr[0], &tmp, sizeof(void *));
+		ptr[0]++, ptr[1]--;
+	}
+
+	return(TRUE);
+}
+
+int voidlist_rotate(VoidListPtr list, long amount, long index, unsigned long size)
+{
+	void **tmp, **ptr[2];
+	unsigned long list_size = list->ptr - list->start;
+
+	if(!list_size || index + size > list_size)
+		return(FALSE);
+
+	if(!size)
+		size = list_size - index;
+
+	if(size < 2)
+		return(TRUE);
+
+	if(!(ptr[0] = VoidListPointer(list, index)))
+		return(FALSE);
+
+	ptr[1] = ptr[0] + size;
+
+	if((tmp = lists_malloc(labs(amount) * sizeof(void *))) == NULL)
+		return(FALSE);
+
+	if(amount > 0) {
+		memcpy(tmp, ptr[1] - amount, sizeof(void *) * amount);
+		memmove(ptr[0] + amount, ptr[0], sizeof(void *) * (size - amount));
+		memcpy(ptr[0], tmp, sizeof(void *) * amount);
+	} else {
+		amount = -amount;
+		memcpy(tmp, ptr[0], sizeof(void *) * amount);
+		memmove(ptr[0], ptr[0] + amount, sizeof(void *) * (size - amount));
+		memcpy(ptr[1] - amount, tmp, sizeof(void *) * amount);
+	}
+
+	lists_free(tmp);
+
+	return(TRUE);
+}
+
+int VoidListRotate(VoidListPtr list, long amount, long index, unsigned long size)
+{
+	unsigned long start = lists_trace_start();
+	int result = voidlist_rotate(list, amount, index, size);
+
+	LISTS_PROBE4(rotate, list, amount, index, (size ? size : (list->ptr - list->start) - index) * sizeof(void *));
+	lists_trace_stop(LISTS_OP_ROTATE, start);
+
+	return(result);
+}
+
+int voidlist_copy(VoidListPtr dest, VoidListPtr src, long index, unsigned long size)
+{
+	void **ptr;
+	unsigned long dest_size = dest->ptr - dest->start,
+			src_size = src->ptr - src->start;
+
+	if(index + size > src_size)
+		return(FALSE);
+
+	if(!(ptr = VoidListPointer(src, index)))
+		return(FALSE);
+
+	if(!size)
+		size = src_size - index;
+
+	if(!VoidListReserve(dest, dest_size + size, src->grow, 0))
+		return(FALSE);
+
+	while(size--)
+		dest->alloc_func(dest, dest->ptr++, *ptr++, src->width);
+
+	return(TRUE);
+}
+
+int VoidListCopy(VoidListPtr dest, VoidListPtr src, long index, unsigned long size)
+{
+	unsigned long start = lists_trace_start(), before = dest->ptr - dest->start;
+	int result = voidlist_copy(dest, src, index, size);
+
+	LISTS_PROBE4(copy, dest, src, (dest->ptr - dest->start) - before, ((dest->ptr - dest->start) - before) * sizeof(void *));
+	lists_trace_stop(LISTS_OP_COPY, start);
+
+	return(result);
+}
+
+int VoidListMove(VoidListPtr dest, VoidListPtr src, long index, unsigned long size)
+{
+	if(!(VoidListCopy(dest, src, index, size)))
+		return(FALSE);
+
+	if(!VoidListResize(src, 0, NULL, 0))
+		return(FALSE);
+
+	return(TRUE);
+}
+
+int VoidListRemoveIndices(VoidListPtr list, IntListPtr indices)
+{
+	unsigned long i, size = list->ptr - list->start, kept = 0;
+	void *batch[LISTS_FREE_BATCH];
+	long n = 0;
+	unsigned char *map;
+
+	if(!(map = lists_index_map(indices, size)))
+		return(FALSE);
+
+	for(i = 0; i < size; i++)
+		if(map[i]) {
+			if(n == LISTS_FREE_BATCH)
+				n = voidlist_free_block(list, batch, n);
+			batch[n++] = list->start[i];
+		} else
+			list->start[kept++] = list->start[i];
+
+	voidlist_free_block(list, batch, n);
+	lists_free(map);
+
+	list->ptr = list->start + kept;
+
+	VoidListReserve(list, 0, 0, 0);
+
+	return(TRUE);
+}
+
+int VoidListRemoveIf(VoidListPtr list, VoidListFilterFunc remove_func, void *custom)
+{
+	unsigned long i, size = list->ptr - list->start, kept = 0;
+	void *batch[LISTS_FREE_BATCH];
+	long n = 0;
+
+	for(i = 0; i < size; i++)
+		if(remove_func(list, list->start[i], custom)) {
+			if(n == LISTS_FREE_BATCH)
+				n = voidlist_free_block(list, batch, n);
+			batch[n++] = list->start[i];
+		} else
+			list->start[kept++] = list->start[i];
+
+	voidlist_free_block(list, batch, n);
+
+	if(kept == size)
+		return(TRUE);
+
+	list->ptr = list->start + kept;
+
+	VoidListReserve(list, 0, 0, 0);
+
+	return(TRUE);
+}
+
+int VoidListSwapRemove(VoidListPtr list, long index)
+{
+	unsigned long size;
+	void **ptr;
+
+	if(!(ptr = VoidListPointer(list, index)))
+		return(FALSE);
+
+	list->free_func(list, *ptr);
+	*ptr = *--list->ptr;
+
+	if(list->reserve - (list->grow << 1) >= (size = list->ptr - list->start))
+		VoidListReserve(list, size, 0, 0);
+
+	return(TRUE);
+}
+
+int VoidListSort(VoidListPtr list)
+{
+	ListsSortType job;
+
+	job.start = (char *)list->start;
+	job.size = list->ptr - list->start;
+	job.width = sizeof(void *);
+	job.threads = 1;
+	job.cmp_func = lists_sort_void;
+	job.list = list;
+
+	return(lists_sort(&job));
+}
+
+int VoidListSortParallel(VoidListPtr list, int threads)
+{
+	ListsSortType job;
+
+	job.start = (char *)list->start;
+	job.size = list->ptr - list->start;
+	job.width = sizeof(void *);
+	job.threads = lists_threads(threads);
+	job.cmp_func = lists_sort_void;
+	job.list = list;
+
+	return(lists_sort(&job));
+}
+
+/* Void List heap functions */
+int voidlist_heap_before(VoidListPtr list, void *a, void *b, int flags)
+{
+	int cmp = list->cmp_func(list, a, b, list->width);
+
+	return(flags & LISTS_HEAP_MAX ? cmp > 0 : cmp < 0);
+}
+
+void voidlist_sift_up(VoidListPtr list, void **base, unsigned long i, int flags)
+{
+	unsigned long d = flags & LISTS_HEAP_4ARY ? 4 : 2, parent;
+	void *value = base[i];
+
+	for(; i && voidlist_heap_before(list, value, base[parent = (i - 1) / d], flags); i = parent)
+		base[i] = base[parent];
+
+	base[i] = value;
+}
+
+void voidlist_sift_down(VoidListPtr list, void **base, unsigned long i, unsigned long size, int flags)
+{
+	unsigned long d = flags & LISTS_HEAP_4ARY ? 4 : 2, child, best, last;
+	void *value = base[i];
+
+	while((child = i * d + 1) < size) {
+		last = child + d < size ? child + d : size;
+		for(best = child++; child < last; child++)
+			if(voidlist_heap_before(list, base[child], base[best], flags))
+				best = child;
+
+		if(!voidlist_heap_before(list, base[best], value, flags))
+			break;
+
+		base[i] = base[best];
+		i = best;
+	}
+
+	base[i] = value;
+}
+
+void voidlist_heapify(VoidListPtr list, void **base, unsigned long size, int flags)
+{
+	unsigned long d = flags & LISTS_HEAP_4ARY ? 4 : 2, i;
+
+	if(size < 2)
+		return;
+
+	for(i = (size - 2) / d + 1; i--;)
+		voidlist_sift_down(list, base, i, size, flags);
+}
+
+int VoidListHeapify(VoidListPtr list, int flags)
+{
+	voidlist_heapify(list, list->start, list->ptr - list->start, flags);
+
+	return(TRUE);
+}
+
+void *VoidListHeapPush(VoidListPtr list, void *value, size_t width, int flags)
+{
+	void *ptr;
+
+	if((ptr = VoidListPush(list, value, width)) == NULL)
+		return(NULL);
+
+	voidlist_sift_up(list, list->start, list->ptr - list->start - 1, flags);
+
+	return(ptr);
+}
+
+/* The top swaps with the last element, which VoidListPop copies out and frees */
+void *VoidListHeapPop(VoidListPtr list, void *value, size_t width, int flags)
+{
+	void *top;
+
+	if(list->ptr <= list->start)
+		return(NULL);
+
+	top = *list->start;
+	*list->start = list->ptr[-1];
+	list->ptr[-1] = top;
+	voidlist_sift_down(list, list->start, 0, list->ptr - list->start - 1, flags);
+
+	return(VoidListPop(list, value, width));
+}
+
+int VoidListHeapReplace(VoidListPtr list, void *value, size_t width, void *top, int flags)
+{
+	if(list->ptr <= list->start)
+		return(FALSE);
+
+	if(top)
+		list->cpy_func(list, top, *list->start, width ? width : list->width);
+
+	if(!VoidListSet(list, 0, value, width))
+		return(FALSE);
+
+	voidlist_sift_down(list, list->start, 0, list->ptr - list->start, flags);
+
+	return(TRUE);
+}
+
+void *VoidListHeapPeek(VoidListPtr list)
+{
+	return(list->ptr > list->start ? *list->start : NULL);
+}
+
+void voidlist_heap_select(VoidListPtr list, void **a, unsigned long size, unsigned long k, int flags)
+{
+	unsigned long i;
+	void *swap;
+
+	voidlist_heapify(list, a, k, flags ^ LISTS_HEAP_MAX);
+
+	for(i = k; i < size; i++)
+		if(voidlist_heap_before(list, a[i], a[0], flags)) {
+			swap = a[i];
+			a[i] = a[0];
+			a[0] = swap;
+			voidlist_sift_down(list, a, 0, k, flags ^ LISTS_HEAP_MAX);
+		}
+}
+
+/* Same introselect as the Int List version, comparing through cmp_func */
+void voidlist_select(VoidListPtr list, void **a, unsigned long size, unsigned long k, int flags)
+{
+	unsigned long lo = 0, hi = size, depth = 0;
+	long i, j;
+	void *pivot, *swap, *x, *y, *z;
+
+	if(!k || k >= size)
+		return;
+
+	if(k * 64 < size) {
+		voidlist_heap_select(list, a, size, k, flags);
+		return;
+	}
+
+	for(i = size; i; i >>= 1)
+		depth += 2;
+
+	while(hi - lo > LISTS_SELECT_MIN) {
+		if(!depth--) {
+			voidlist_heap_select(list, a + lo, hi - lo, k - lo, flags);
+			return;
+		}
+
+		x = a[lo];
+		y = a[lo + (hi - lo) / 2];
+		z = a[hi - 1];
+		if(voidlist_heap_before(list, y, x, flags)) {
+			swap = x; x = y; y = swap;
+		}
+		pivot = voidlist_heap_before(list, z, y, flags) ? (voidlist_heap_before(list, z, x, flags) ? x : z) : y;
+
+		for(i = lo, j = hi - 1; i <= j;) {
+			while(voidlist_heap_before(list, a[i], pivot, flags))
+				i++;
+			while(voidlist_heap_before(list, pivot, a[j], flags))
+				j--;
+			if(i <= j) {
+				swap = a[i];
+				a[i++] = a[j];
+				a[j--] = swap;
+			}
+		}
+
+		if((long)k <= j)
+			hi = j + 1;
+		else if((long)k >= i)
+			lo = i;
+		else
+			return;
+	}
+
+	for(i = lo + 1; i < (long)hi; i++) {
+		for(x = a[i], j = i; j > (long)lo && voidlist_heap_before(list, x, a[j - 1], flags); j--)
+			a[j] = a[j - 1];
+		a[j] = x;
+	}
+}
+
+int VoidListPartialSort(VoidListPtr list, unsigned long k, int flags)
+{
+	unsigned long i, size = list->ptr - list->start;
+	void **tmp, *swap;
+
+	if(k > size)
+		k = size;
+
+	if((tmp = lists_malloc((k ? k : 1) * sizeof(void *))) == NULL)
+		return(FALSE);
+
+	voidlist_select(list, list->start, size, k, flags);
+	voidlist_merge_sort(list, list->start, tmp, k);
+	lists_free(tmp);
+
+	if(flags & LISTS_HEAP_MAX)
+		for(i = 0; i < k / 2; i++) {
+			swap = list->start[i];
+			list->start[i] = list->start[k - 1 - i];
+			list->start[k - 1 - i] = swap;
+		}
+
+	return(TRUE);
+}
+
+int VoidListUniqueParallel(VoidListPtr list, int threads)
+{
+	ListsSortType job;
+	unsigned long size;
+
+	if(!VoidListSortParallel(list, threads))
+		return(FALSE);
+
+	job.start = (char *)list->start;
+	job.size = list->ptr - list->start;
+	job.width = sizeof(void *);
+	job.threads = lists_threads(threads);
+	job.cmp_func = lists_sort_void;
+	job.list = list;
+
+	if(!lists_unique(&job))
+		return(FALSE);
+
+	list->ptr = list->start + (size = job.size);
+	if(list->reserve - (list->grow << 1) >= size)
+		VoidListReserve(list, size, 0, 0);
+
+	return(TRUE);
+}
+
+/* Void List mapping functions */
+int VoidListMap(VoidListPtr list, VoidListMapFunc map_func, void *custom)
+{
+	void **ptr = list->start;
+	long index = 0;
+	unsigned long distance = lists_prefetch;
+
+	while(ptr < list->ptr) {
+		if(distance && (unsigned long)(list->ptr - ptr) > distance)
+			lists_prefetch_addr(ptr[distance]);
+		*ptr = map_func(list, index++, *ptr, custom);
+		ptr++;
+	}
+
+	return(TRUE);
+}
+
+int voidlist_filter(VoidListPtr list, VoidListFilterFunc filter_func, void *custom)
+{
+	void **ptr = list->ptr;
+	long n;
+
+	while(--ptr >= list->start)
+		if(!filter_func(list, *ptr, custom)) {
+			list->free_func(list, *ptr);
+
+			if((n = --list->ptr - ptr))
+				memmove(ptr, ptr + 1, n * sizeof(long));
+		}
+
+	return(TRUE);
+}
+
+int VoidListFilter(VoidListPtr list, VoidListFilterFunc filter_func, void *custom)
+{
+	unsigned long start = lists_trace_start(), before = list->ptr - list->start;
+	int result = voidlist_filter(list, filter_func, custom);
+
+	LISTS_PROBE3(filter, list, before, list->ptr - list->start);
+	lists_trace_stop(LISTS_OP_FILTER, start);
+
+	return(result);
+}
+
+int VoidListReduce(VoidListPtr list, VoidListReduceFunc reduce_func, void **value, void *initial, void *custom)
+{
+	unsigned long size = list->ptr - list->start, distance = lists_prefetch;
+
+	while(size--) {
+		if(distance && size >= distance)
+			lists_prefetch_addr(list->start[size - distance]);
+		initial = reduce_func(list, initial, list->start[size], custom);
+	}
+
+	if(value)
+		*value = initial;
+
+	return(TRUE);
+}
+
+/* Void List block mapping functions */
+int VoidListMapBlock(VoidListPtr list, VoidListMapBlockFunc map_func, unsigned long block, void *custom)
+{
+	unsigned long index, count, size = list->ptr - list->start;
+
+	if(!block)
+		block = LISTS_BLOCK;
+
+	for(index = 0; index < size; index += count) {
+		count = size - index < block ? size - index : block;
+		map_func(list, index, list->start + index, count, custom);
+	}
+
+	return(TRUE);
+}
+
+/* Survivors swap forward past the dropped elements, which are released together at the end */
+int VoidListFilterBlock(VoidListPtr list, VoidListFilterBlockFunc filter_func, unsigned long block, void *custom)
+{
+	unsigned long index, count, n, kept, keep = 0, size = list->ptr - list->start;
+	unsigned char *mask;
+	void **ptr = list->start, *value;
+
+	if(!block)
+		block = LISTS_BLOCK;
+
+	if((mask = lists_malloc(block)) == NULL)
+		return(FALSE);
+
+	for(index = 0; index < size; index += count) {
+		count = size - index < block ? size - index : block;
+
+		if((kept = filter_func(list, ptr + index, mask, count, custom)) == count && keep == index)
+			keep += count;
+		else if(kept)
+			for(n = 0; n < count; n++)
+				if(mask[n]) {
+					value = ptr[index + n];
+					ptr[index + n] = ptr[keep];
+					ptr[keep++] = value;
+				}
+	}
+
+	lists_free(mask);
+
+	voidlist_free_block(list, ptr + keep, size - keep);
+	list->ptr = ptr + keep;
+
+	return(TRUE);
+}
+
+int VoidListReduceBlock(VoidListPtr list, VoidListReduceBlockFunc reduce_func, unsigned long block, void **value, void *initial, void *custom)
+{
+	unsigned long index, count, size = list->ptr - list->start;
+
+	if(!block)
+		block = LISTS_BLOCK;
+
+	for(index = 0; index < size; index += count) {
+		count = size - index < block ? size - index : block;
+		initial = reduce_func(list, initial, list->start + index, count, custom);
+	}
+
+	if(value)
+		*value = initial;
+
+	return(TRUE);
+}
+
+/* Void List pipeline functions */
+int VoidListPipeInit(VoidListPipePtr pipeline, VoidListPtr list)
+{
+	pipeline->list = list;
+	pipeline->size = 0;
+
+	return(TRUE);
+}
+
+VoidListStagePtr voidlist_pipe_stage(VoidListPipePtr pipeline, int type, unsigned long n, void *custom)
+{
+	VoidListStagePtr stage;
+
+	if(pipeline->size >= LISTS_PIPE_MAX)
+		return(NULL);
+
+	stage = pipeline->stage + pipeline->size++;
+	stage->type = type;
+	stage->map_func = NULL;
+	stage->filter_func = NULL;
+	stage->n = n;
+	stage->custom = custom;
+
+	return(stage);
+}
+
+int VoidListPipeMap(VoidListPipePtr pipeline, VoidListMapFunc map_func, void *custom)
+{
+	VoidListStagePtr stage;
+
+	if(!(stage = voidlist_pipe_stage(pipeline, LISTS_PIPE_MAP, 0, custom)))
+		return(FALSE);
+
+	stage->map_func = map_func;
+
+	return(TRUE);
+}
+
+int VoidListPipeFilter(VoidListPipePtr pipeline, VoidListFilterFunc filter_func, void *custom)
+{
+	VoidListStagePtr stage;
+
+	if(!(stage = voidlist_pipe_stage(pipeline, LISTS_PIPE_FILTER, 0, custom)))
+		return(FALSE);
+
+	stage->filter_func = filter_func;
+
+	return(TRUE);
+}
+
+int VoidListPipeTake(VoidListPipePtr pipeline, unsigned long n)
+{
+	return(voidlist_pipe_stage(pipeline, LISTS_PIPE_TAKE, n, NULL) != NULL);
+}
+
+int VoidListPipeSkip(VoidListPipePtr pipeline, unsigned long n)
+{
+	return(voidlist_pipe_stage(pipeline, LISTS_PIPE_SKIP, n, NULL) != NULL);
+}
+
+/* Runs one value through every stage: 1 = passed, 0 = dropped, -1 = pipeline exhausted */
+int voidlist_pipe_apply(VoidListPipePtr pipeline, unsigned long *seen, void **value)
+{
+	VoidListStagePtr stage = pipeline->stage;
+	int i;
+
+	for(i = 0; i < pipeline->size; i++, stage++)
+		switch(stage->type) {
+		case LISTS_PIPE_MAP:
+			*value = stage->map_func(pipeline->list, seen[i]++, *value, stage->custom);
+			break;
+		case LISTS_PIPE_FILTER:
+			if(!stage->filter_func(pipeline->list, *value, stage->custom))
+				return(0);
+			break;
+		case LISTS_PIPE_TAKE:
+			if(seen[i] >= stage->n)
+				return(-1);
+			seen[i]++;
+			break;
+		case LISTS_PIPE_SKIP:
+			if(seen[i] < stage->n) {
+				seen[i]++;
+				return(0);
+			}
+			break;
+		}
+
+	return(1);
+}
+
+int VoidListPipeReduce(VoidListPipePtr pipeline, VoidListReduceFunc reduce_func, void **value, void *initial, void *custom)
+{
+	VoidListPtr list = pipeline->list;
+	unsigned long seen[LISTS_PIPE_MAX] = { 0 };
+	void **ptr = list->start, *x;
+	int pass;
+
+	while(ptr < list->ptr) {
+		x = *ptr++;
+		if((pass = voidlist_pipe_apply(pipeline, seen, &x)) < 0)
+			break;
+		if(pass)
+			initial = reduce_func(list, initial, x, custom);
+	}
+
+	if(value)
+		*value = initial;
+
+	return(TRUE);
+}
+
+long VoidListPipeCount(VoidListPipePtr pipeline)
+{
+	VoidListPtr list = pipeline->list;
+	unsigned long seen[LISTS_PIPE_MAX] = { 0 };
+	void **ptr = list->start, *x;
+	long count = 0;
+	int pass;
+
+	while(ptr < list->ptr) {
+		x = *ptr++;
+		if((pass = voidlist_pipe_apply(pipeline, seen, &x)) < 0)
+			break;
+		count += pass;
+	}
+
+	return(count);
+}
+
+int VoidListPipeCollect(VoidListPipePtr pipeline, VoidListPtr dest)
+{
+	VoidListPtr list = pipeline->list;
+	unsigned long seen[LISTS_PIPE_MAX] = { 0 },
+			size = list->ptr - list->start;
+	void **ptr = list->start, **end = list->ptr, *x;
+	int i, pass;
+
+	if(dest == list)
+		return(FALSE);
+
+	/* Every take stage caps the output, so reserve for the tightest one */
+	for(i = 0; i < pipeline->size; i++)
+		if(pipeline->stage[i].type == LISTS_PIPE_TAKE && pipeline->stage[i].n < size)
+			size = pipeline->stage[i].n;
+
+	if(!VoidListReserve(dest, (dest->ptr - dest->start) + size, dest->grow ? 0 : list->grow, 0))
+		return(FALSE);
+
+	while(ptr < end) {
+		x = *ptr++;
+		if((pass = voidlist_pipe_apply(pipeline, seen, &x)) < 0)
+			break;
+		if(pass) {
+			if(!dest->alloc_func(dest, dest->ptr, x, list->width))
+				return(FALSE);
+			dest->ptr++;
+		}
+	}
+
+	return(TRUE);
+}
+
+long VoidListPipeFind(VoidListPipePtr pipeline, void **value)
+{
+	VoidListPtr list = pipeline->list;
+	unsigned long seen[LISTS_PIPE_MAX] = { 0 };
+	void **ptr = list->start, *x;
+	int pass;
+
+	while(ptr < list->ptr) {
+		x = *ptr++;
+		if((pass = voidlist_pipe_apply(pipeline, seen, &x)) < 0)
+			break;
+		if(pass) {
+			if(value)
+				*value = x;
+			return(ptr - list->start - 1);
+		}
+	}
+
+	return(-1);
+}
+
+
+
+/* Void List callback functions */
+int voidlist_alloc(VoidListPtr list, void **ptr, void *value, size_t width)
+{
+	unsigned long start = lists_trace_start();
+
+	/* Only blank elements need zeroing, copies overwrite every byte */
+	if((*ptr = value ? lists_malloc(width) : lists_calloc(1, width)) == NULL)
+		return(FALSE);
+
+	if(value)
+		list->cpy_func(list, *ptr, value, width);
+
+	LISTS_PROBE3(alloc, list, *ptr, width);
+	lists_trace_stop(LISTS_OP_ALLOC, start);
+
+	return(TRUE);
+}
+
+void voidlist_free(VoidListPtr list, void *ptr)
+{
+	unsigned long start = lists_trace_start();
+
+	lists_free(ptr);
+
+	LISTS_PROBE2(free, list, ptr);
+	lists_trace_stop(LISTS_OP_FREE, start);
+}
+
+void voidlist_cpy(VoidListPtr list, void *dest, void *src, size_t width)
+{
+	memcpy(dest, src, width);
+}
+
+int voidlist_cmp(VoidListPtr list, void *ptr1, void *ptr2, size_t width)
+{
+	return(memcmp(ptr1, ptr2, width));
+}
+
+
+/**************************
+ *  String Intern Functions
+ */
+unsigned long lists_hash(char *value, size_t *length)
+{
+	unsigned long hash = 2166136261UL;
+	char *ptr = value;
+
+	/* 32-bit FNV-1a */
+	while(*ptr)
+		hash = ((hash ^ (unsigned char)*ptr++) * 16777619UL) & 0xffffffffUL;
+
+	if(length)
+		*length = ptr - value;
+
+	return(hash);
+}
+
+int StrInternInit(StrInternPtr intern, unsigned long reserve)
+{
+	unsigned long size = 16;
+
+	while(size < reserve << 1)
+		size <<= 1;
+
+	intern->count = 0;
+	intern->size = 0;
+
+	if((intern->table = lists_calloc(size, sizeof(StrInternEntryType))) == NULL)
+		return(FALSE);
+
+	intern->size = size;
+
+	return(TRUE);
+}
+
+void StrInternFree(StrInternPtr intern)
+{
+	unsigned long i;
+
+	for(i = 0; i < intern->size; i++)
+		lists_free(intern->table[i].value);
+
+	lists_free(intern->table);
+	intern->table = NULL;
+	intern->size = intern->count = 0;
+}
+
+long StrInternSize(StrInternPtr intern)
+{
+	return(intern->count);
+}
+
+/* Linear probe for value: its slot, or the empty slot it would go in */
+StrInternEntryType *strintern_slot(StrInternPtr intern, char *value, unsigned long hash)
+{
+	unsigned long mask = intern->size - 1, i = hash & mask;
+	StrInternEntryType *entry;
+
+	while((entry = intern->table + i)->value) {
+		if(entry->hash == hash && (entry->value == value || !strcmp(entry->value, value)))
+			break;
+		i = (i + 1) & mask;
+	}
+
+	return(entry);
+}
+
+int strintern_grow(StrInternPtr intern)
+{
+	StrInternEntryType *table = intern->table, *entry;
+	unsigned long i, size = intern->size;
+
+	if((intern->table = lists_calloc(size << 1, sizeof(StrInternEntryType))) == NULL) {
+		intern->table = table;
+		return(FALSE);
+	}
+
+	intern->size = size << 1;
+
+	for(i = 0; i < size; i++)
+		if(table[i].value) {
+			entry = strintern_slot(intern, table[i].value, table[i].hash);
+			*entry = table[i];
+		}
+
+	lists_free(table);
+
+	return(TRUE);
+}
+
+char *StrInternAcquire(StrInternPtr intern, char *value)
+{
+	StrInternEntryType *entry;
+	unsigned long hash;
+	size_t length;
+
+	hash = lists_hash(value, &length);
+	entry = strintern_slot(intern, value, hash);
+
+	if(!entry->value) {
+		/* Keep the load factor at or below a half */
+		if((intern->count + 1) << 1 > intern->size) {
+			if(!strintern_grow(intern))
+				return(NULL);
+			entry = strintern_slot(intern, value, hash);
+		}
+
+		if((entry->value = lists_malloc(length + 1)) == NULL)
+			return(NULL);
+
+		memcpy(entry->value, value, length + 1);
+		entry->hash = hash;
+		entry->refs = 0;
+		intern->count++;
+	}
+
+	entry->refs++;
+
+	return(entry->value);
+}
+
+char *StrInternLookup(StrInternPtr intern, char *value)
+{
+	return(strintern_slot(intern, value, lists_hash(value, NULL))->value);
+}
+
+void StrInternRelease(StrInternPtr intern, char *value)
+{
+	unsigned long mask = intern->size - 1, i, j, home;
+	StrInternEntryType *entry = strintern_slot(intern, value, lists_hash(value, NULL));
+
+	if(!entry->value || --entry->refs)
+		return;
+
+	lists_free(entry->value);
+	entry->value = NULL;
+	intern->count--;
+
+	/* Backward-shift the rest of the probe run so no tombstones are needed */
+	i = entry - intern->table;
+	for(j = (i + 1) & mask; intern->table[j].value; j = (j + 1) & mask) {
+		home = intern->table[j].hash & mask;
+		if(((j - home) & mask) >= ((j - i) & mask)) {
+			intern->table[i] = intern->table[j];
+			intern->table[j].value = NULL;
+			i = j;
+		}
+	}
+}
+
+/* Interned String List functions */
+int StrListInitIntern(StrListPtr list, long reserve, long grow, StrInternPtr intern)
+{
+	if(!VoidListInit(list, reserve, grow, 0, strlist_intern_alloc, strlist_intern_free, strlist_cpy, strlist_cmp))
+		return(FALSE);
+
+	list->custom = intern;
+
+	return(TRUE);
+}
+
+int strlist_intern_alloc(VoidListPtr list, void **ptr, void *value, size_t width)
+{
+	return((*ptr = StrInternAcquire(list->custom, value ? value : "")) != NULL);
+}
+
+void strlist_intern_free(VoidListPtr list, void *ptr)
+{
+	StrInternRelease(list->custom, ptr);
+}
+
+/* Every entry is canonical, so a needle missing from the table can't be in the list */
+long strlist_intern_find(StrListPtr list, char *value)
+{
+	void **ptr = list->ptr;
+
+	if(!(value = StrInternLookup(list->custom, value)))
+		return(-1);
+
+	while(--ptr >= list->start)
+		if(*ptr == value)
+			return(ptr - list->start);
+
+	return(-1);
+}
+
+
+/* Hashed String List functions */
+int StrListInitHashed(StrListPtr list, long reserve, long grow)
+{
+	return(VoidListInit(list, reserve, grow, 0, strlist_hash_alloc, strlist_hash_free, strlist_hash_cpy, strlist_cmp));
+}
+
+int strlist_hash_alloc(VoidListPtr list, void **ptr, void *value, size_t width)
+{
+	StrListHeadPtr head;
+	unsigned long hash;
+	size_t length;
+
+	if(!value)
+		value = "";
+
+	hash = lists_hash(value, &length);
+
+	if((head = lists_malloc(sizeof(StrListHeadType) + length + 1)) == NULL)
+		return(FALSE);
+
+	head->length = length;
+	head->hash = hash;
+	memcpy(head + 1, value, length + 1);
+	*ptr = head + 1;
+
+	return(TRUE);
+}
+
+void strlist_hash_free(VoidListPtr list, void *ptr)
+{
+	lists_free((StrListHeadPtr)ptr - 1);
+}
+
+void strlist_hash_cpy(VoidListPtr list, void *dest, void *src, size_t width)
+{
+	memcpy(dest, src, ((StrListHeadPtr)src - 1)->length + 1);
+}
+
+/* Rejects on hash and length before touching any characters */
+long strlist_hash_find(StrListPtr list, char *value)
+{
+	void **ptr = list->ptr;
+	StrListHeadPtr head;
+	unsigned long hash;
+	size_t length;
+
+	hash = lists_hash(value, &length);
+
+	while(--ptr >= list->start) {
+		if(lists_prefetch && ptr - list->start >= (long)lists_prefetch)
+			lists_prefetch_addr((StrListHeadPtr)ptr[-(long)lists_prefetch] - 1);
+		head = (StrListHeadPtr)*ptr - 1;
+		if(head->hash == hash && head->length == length && !memcmp(*ptr, value, length))
+			return(ptr - list->start);
+	}
+
+	return(-1);
+}
+
+
+/* String List index functions */
+typedef struct {
+	char *value;
+	long index;
+} StrListSortType;
+
+int strlist_index_cmp(const void *ptr1, const void *ptr2)
+{
+	const StrListSortType *a = ptr1, *b = ptr2;
+	int cmp;
+
+	if((cmp = strcmp(a->value, b->value)))
+		return(cmp);
+
+	return(a->index < b->index ? -1 : a->index > b->index);
+}
+
+char *strlist_index_str(StrListIndexPtr index, unsigned long position)
+{
+	return(index->list->start[intlist_load(index->order.width, intlist_at(&index->order, position))]);
+}
+
+long strlist_index_node(StrListIndexPtr index, unsigned long count)
+{
+	StrListNodePtr node;
+	unsigned long reserve = index->reserve;
+
+	while(index->nodes + count > reserve)
+		reserve = reserve ? reserve << 1 : 64;
+
+	if(reserve != index->reserve) {
+		if((node = lists_realloc(index->node, reserve * sizeof(StrListNodeType))) == NULL)
+			return(-1);
+		index->node = node;
+		index->reserve = reserve;
+	}
+
+	index->nodes += count;
+
+	return(index->nodes - count);
+}
+
+/* Splits a node's sorted range by the next byte, one child per run, each cut at the run's common prefix */
+int strlist_index_split(StrListIndexPtr index, char **sorted, unsigned long node)
+{
+	unsigned long lo = index->node[node].lo, hi = index->node[node].hi,
+			depth = index->node[node].depth, a, b, e, d, count = 0;
+	long child;
+	StrListNodePtr ptr;
+
+	for(a = lo; a < hi && !sorted[a][depth]; a++);
+	index->node[node].term = a - lo;
+
+	for(b = a; b < hi; b = e, count++)
+		for(e = b + 1; e < hi && sorted[e][depth] == sorted[b][depth]; e++);
+
+	index->node[node].children = count;
+	index->node[node].child = 0;
+
+	if(!count)
+		return(TRUE);
+
+	if((child = strlist_index_node(index, count)) < 0)
+		return(FALSE);
+
+	index->node[node].child = child;
+
+	for(b = a, ptr = index->node + child; b < hi; b = e, ptr++) {
+		for(e = b + 1; e < hi && sorted[e][depth] == sorted[b][depth]; e++);
+		for(d = depth + 1; sorted[b][d] && sorted[b][d] == sorted[e - 1][d]; d++);
+		ptr->lo = b;
+		ptr->hi = e;
+		ptr->depth = d;
+	}
+
+	for(b = 0; b < count; b++)
+		if(!strlist_index_split(index, sorted, child + b))
+			return(FALSE);
+
+	return(TRUE);
+}
+
+int StrListIndexBuild(StrListIndexPtr index, StrListPtr list)
+{
+	unsigned long i, size = list->ptr - list->start;
+	StrListSortType *sort;
+	char **sorted;
+	int ok;
+
+	index->list = list;
+	index->node = NULL;
+	index->nodes = index->reserve = 0;
+
+	if(!IntListInitWidth(&index->order, size, size ? size : 1, 1))
+		return(FALSE);
+
+	if((sort = lists_malloc((size ? size : 1) * sizeof(StrListSortType))) == NULL) {
+		IntListFree(&index->order);
+		return(FALSE);
+	}
+
+	for(i = 0; i < size; i++) {
+		sort[i].value = list->start[i];
+		sort[i].index = i;
+	}
+
+	qsort(sort, size, sizeof(StrListSortType), strlist_index_cmp);
+
+	/* Reuse the pair array as the sorted string column */
+	sorted = (char **)sort;
+	for(i = 0; i < size; i++) {
+		IntListPush(&index->order, sort[i].index);
+		sorted[i] = sort[i].value;
+	}
+
+	ok = strlist_index_node(index, 1) == 0;
+	if(ok) {
+		index->node->lo = 0;
+		index->node->hi = size;
+		index->node->depth = 0;
+		ok = strlist_index_split(index, sorted, 0);
+	}
+
+	lists_free(sort);
+
+	if(!ok)
+		StrListIndexFree(index);
+
+	return(ok);
+}
+
+void StrListIndexFree(StrListIndexPtr index)
+{
+	IntListFree(&index->order);
+	lists_free(index->node);
+
+	index->node = NULL;
+	index->nodes = index->reserve = 0;
+}
+
+StrListNodePtr strlist_index_child(StrListIndexPtr index, StrListNodePtr node, unsigned char c)
+{
+	unsigned long lo = node->child, hi = node->child + node->children, mid;
+	unsigned char label;
+
+	while(lo < hi) {
+		mid = (lo + hi) >> 1;
+		label = strlist_index_str(index, index->node[mid].lo)[node->depth];
+		if(label == c)
+			return(index->node + mid);
+		if(label < c)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return(NULL);
+}
+
+long StrListIndexFind(StrListIndexPtr index, char *value)
+{
+	StrListNodePtr node = index->node, child;
+	long i;
+
+	if(!node)
+		return(-1);
+
+	while(value[node->depth]) {
+		if(!(child = strlist_index_child(index, node, value[node->depth])))
+			return(-1);
+
+		if(strncmp(value + node->depth + 1, strlist_index_str(index, child->lo) + node->depth + 1,
+				child->depth - node->depth - 1))
+			return(-1);
+
+		node = child;
+	}
+
+	if(!node->term || !IntListGet(&index->order, node->lo, &i))
+		return(-1);
+
+	return(i);
+}
+
+int StrListIndexPrefix(StrListIndexPtr index, char *prefix, long *first, long *count)
+{
+	StrListNodePtr node = index->node, child;
+	size_t length = strlen(prefix);
+
+	while(node && length > node->depth) {
+		if((child = strlist_index_child(index, node, prefix[node->depth])))
+			/* The prefix may end part way along the child's edge */
+			if(strncmp(prefix + node->depth + 1, strlist_index_str(index, child->lo) + node->depth + 1,
+					(length < child->depth ? length : child->depth) - node->depth - 1))
+				child = NULL;
+
+		node = child;
+	}
+
+	if(first)
+		*first = node ? node->lo : 0;
+
+	if(count)
+		*count = node ? node->hi - node->lo : 0;
+
+	return(node && node->hi > node->lo);
+}
+
+long StrListIndexGet(StrListIndexPtr index, long position)
+{
+	long i;
+
+	if(!IntListGet(&index->order, position, &i))
+		return(-1);
+
+	return(i);
+}
+
+
+/**************************
+ *  String List Functions
+ */
+int StrListInit(StrListPtr list, long reserve, long grow)
+{
+	return(VoidListInit(list, reserve, grow, 0, strlist_alloc, voidlist_free, strlist_cpy, strlist_cmp));
+}
+
+void StrListDump(StrListPtr list, FILE *stream, int type)
+{
+	_VoidListDump(list, stream, type, "String List");
+}
+
+int StrListReserve(VoidListPtr list, unsigned long size, unsigned long grow)
+{
+	return(VoidListReserve(list, size, grow, 0));
+}
+
+int StrListResize(StrListPtr list, unsigned long size, char *value)
+{
+	return(VoidListResize(list, size, value, 0));
+}
+char *StrListPush(StrListPtr list, char *value)
+{
+	return (char *)VoidListPush(list, value, 0);
+}
+
+char *StrListHeapPush(StrListPtr list, char *value, int flags)
+{
+	return (char *)VoidListHeapPush(list, value, 0, flags);
+}
+
+char *StrListHeapPop(StrListPtr list, char *value, int flags)
+{
+	return (char *)VoidListHeapPop(list, value, 0, flags);
+}
+
+char *StrListPop(StrListPtr list, char *value)
+{
+	return (char *)VoidListPop(list, value, 0);
+}
+
+int StrListSet(StrListPtr list, long index, char *value)
+{
+	return(VoidListSet(list, index, value, 0));
+}
+
+int StrListGet(StrListPtr list, long index, char *value)
+{
+	return(VoidListGet(list, index, value, 0));
+}
+
+int StrListGetN(StrListPtr list, long index, char *value, size_t size)
+{
+	void **ptr;
+	size_t length;
+
+	if(!(ptr = VoidListPointer(list, index)) || !size)
+		return(FALSE);
+
+	if(list->alloc_func == strlist_hash_alloc)
+		length = ((StrListHeadPtr)*ptr - 1)->length;
+	else
+		length = strlen(*ptr);
+
+	/* Truncate to the caller's buffer and report it */
+	if(length >= size) {
+		memcpy(value, *ptr, size - 1);
+		value[size - 1] = 0;
+		return(FALSE);
+	}
+
+	memcpy(value, *ptr, length + 1);
+
+	return(TRUE);
+}
+
+long StrListFind(StrListPtr list, char *value)
+{
+	if(list->alloc_func == strlist_intern_alloc)
+		return(strlist_intern_find(list, value));
+
+	if(list->alloc_func == strlist_hash_alloc)
+		return(strlist_hash_find(list, value));
+
+	/* Note: this will bash current compare function */
+	list->cmp_func = strlist_cmp;
+	return(VoidListFind(list, value, 0));
+}
+
+long StrListFindCase(StrListPtr list, char *value)
+{
+	/* Note: this will bash current compare function */
+	list->cmp_func = strlist_icmp;
+	return(VoidListFind(list, value, 0));
+}
+
+int StrListFindPrefix(StrListPtr list, char *prefix, long *first, long *count)
+{
+	long lo = 0, hi = list->ptr - list->start, mid, end;
+	size_t length = strlen(prefix);
+
+	/* Sorted lists only: first entry not below the prefix... */
+	while(lo < hi) {
+		mid = (lo + hi) >> 1;
+		if(strcmp(list->start[mid], prefix) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	/* ...then the first one past every string sharing it */
+	end = list->ptr - list->start;
+	while(hi < end) {
+		mid = (hi + end) >> 1;
+		if(strncmp(list->start[mid], prefix, length) > 0)
+			end = mid;
+		else
+			hi = mid + 1;
+	}
+
+	if(first)
+		*first = lo;
+
+	if(count)
+		*count = end - lo;
+
+	return(end > lo);
+}
+
+/* Hashed lists already carry each entry's hash */
+unsigned long strlist_entry_hash(StrListPtr list, char *value)
+{
+	if(list->alloc_func == strlist_hash_alloc)
+		return(((StrListHeadPtr)value - 1)->hash);
+
+	return(lists_hash(value, NULL));
+}
+
+/* Returns the string's index + 1 within base, or 0 after adding it as index + 1 == position */
+unsigned long strlist_table_find(ListsTablePtr table, void **base, char *value, unsigned long hash,
+		unsigned long position)
+{
+	unsigned long slot;
+
+	for(slot = hash & table->mask; table->index[slot]; slot = (slot + 1) & table->mask)
+		if(table->hash[slot] == hash && (base[table->index[slot] - 1] == value
+				|| !strcmp(base[table->index[slot] - 1], value)))
+			return(table->index[slot]);
+
+	table->hash[slot] = hash;
+	table->index[slot] = position;
+	table->count++;
+
+	return(0);
+}
+
+unsigned long StrListEstimate(StrListPtr list)
+{
+	unsigned char reg[1 << LISTS_HLL_BITS];
+	void **ptr;
+
+	memset(reg, 0, sizeof(reg));
+
+	for(ptr = list->start; ptr < list->ptr; ptr++)
+		lists_hll_add(reg, lists_hash_long(strlist_entry_hash(list, *ptr)));
+
+	return(lists_hll_estimate(reg));
+}
+
+/* Keeps first occurrences in order; duplicates are released through free_func */
+int StrListUnique(StrListPtr list, unsigned long expect)
+{
+	ListsTableType table;
+	void **ptr = list->start, *value;
+	unsigned long i, size = list->ptr - list->start, keep = 0;
+
+	if(!lists_table_init(&table, expect, FALSE))
+		return(FALSE);
+
+	/* Survivors swap forward, leaving the duplicates behind them */
+	for(i = 0; i < size; i++) {
+		value = ptr[i];
+		if(!strlist_table_find(&table, ptr, value, strlist_entry_hash(list, value), keep + 1)) {
+			ptr[i] = ptr[keep];
+			ptr[keep++] = value;
+			if(!lists_table_grow(&table)) {
+				lists_table_free(&table);
+				return(FALSE);
+			}
+		}
+	}
+
+	lists_table_free(&table);
+
+	voidlist_free_block(list, ptr + keep, size - keep);
+	list->ptr = ptr + keep;
+	if(list->reserve - (list->grow << 1) >= keep)
+		VoidListReserve(list, keep, 0, 0);
+
+	return(TRUE);
+}
+
+/* Fills values with copies of the distinct strings in first-seen order and counts with their tallies */
+int StrListCount(StrListPtr list, StrListPtr values, IntListPtr counts, unsigned long expect)
+{
+	ListsTableType table;
+	void **ptr;
+	unsigned long index;
+	int ok = TRUE;
+
+	voidlist_free_block(values, values->start, values->ptr - values->start);
+	values->ptr = values->start;
+	counts->ptr = counts->start;
+
+	if(!IntListWiden(counts, sizeof(long)) || !lists_table_init(&table, expect, FALSE))
+		return(FALSE);
+
+	for(ptr = list->start; ptr < list->ptr && ok; ptr++) {
+		if((index = strlist_table_find(&table, values->start, *ptr, strlist_entry_hash(list, *ptr),
+				values->ptr - values->start + 1)))
+			((long *)counts->start)[index - 1]++;
+		else
+			ok = StrListPush(values, *ptr) && IntListPush(counts, 1) && lists_table_grow(&table);
+	}
+
+	lists_table_free(&table);
+
+	return(ok);
+}
+
+int StrListRemoveIf(StrListPtr list, StrListFilterFunc remove_func, void *custom)
+{
+	return(VoidListRemoveIf(list, (VoidListFilterFunc *)remove_func, custom));
+}
+
+/* String mapping functions */
+int StrListMap(StrListPtr list, StrListMapFunc map_func, void *custom)
+{
+	return(VoidListMap(list, (VoidListMapFunc *)map_func, custom));
+}
+
+int StrListFilter(StrListPtr list, StrListFilterFunc filter_func, void *custom)
+{
+	return(VoidListFilter(list, (VoidListFilterFunc *)filter_func, custom));
+}
+
+int StrListReduce(StrListPtr list, StrListReduceFunc reduce_func, void **value, void *initial, void *custom)
+{
+	return(VoidListReduce(list, (VoidListReduceFunc *)reduce_func, value, initial, custom));
+}
+
+/* String block mapping functions */
+int StrListMapBlock(StrListPtr list, StrListMapBlockFunc map_func, unsigned long block, void *custom)
+{
+	return(VoidListMapBlock(list, (VoidListMapBlockFunc *)map_func, block, custom));
+}
+
+int StrListFilterBlock(StrListPtr list, StrListFilterBlockFunc filter_func, unsigned long block, void *custom)
+{
+	return(VoidListFilterBlock(list, (VoidListFilterBlockFunc *)filter_func, block, custom));
+}
+
+int StrListReduceBlock(StrListPtr list, StrListReduceBlockFunc reduce_func, unsigned long block, void **value, void *initial, void *custom)
+{
+	return(VoidListReduceBlock(list, (VoidListReduceBlockFunc *)reduce_func, block, value, initial, custom));
+}
+
+int strlist_write(StrListPtr list, ListsWriterPtr writer, char delimiter)
+{
+	void **ptr;
+	size_t length;
+
+	for(ptr = list->start; ptr < list->ptr; ptr++) {
+		length = strlen(*ptr);
+		lists_writer_put(writer, *ptr, length);
+		if(writer->used == LISTS_WRITE_BUFFER)
+			lists_writer_flush(writer, NULL, 0);
+		writer->buffer[writer->used++] = delimiter;
+	}
+
+	return(lists_writer_flush(writer, NULL, 0));
+}
+
+/* Writes each string followed by delimiter; long strings go out straight from the list */
+int StrListWrite(StrListPtr list, FILE *stream, char delimiter)
+{
+	ListsWriterType writer;
+
+	writer.stream = stream;
+	writer.error = FALSE;
+	writer.used = 0;
+
+	return(strlist_write(list, &writer, delimiter));
+}
+
+int StrListWriteFd(StrListPtr list, int fd, char delimiter)
+{
+	ListsWriterType writer;
+
+	writer.stream = NULL;
+	writer.fd = fd;
+	writer.error = FALSE;
+	writer.used = 0;
+
+	return(strlist_write(list, &writer, delimiter));
+}
+
+void StrListPrint(VoidListPtr list, FILE *stream, VoidListMapFunc func)
+{
+	if(!func) {
+		fprintf(stream, "[ ");
+		StrListWrite(list, stream, ' ');
+		fprintf(stream, "]\n");
+		return;
+	}
+
+	VoidListPrint(list, stream, func);
+}
+
+/* String pipeline functions */
+int StrListPipeMap(StrListPipePtr pipeline, StrListMapFunc map_func, void *custom)
+{
+	return(VoidListPipeMap(pipeline, (VoidListMapFunc *)map_func, custom));
+}
+
+int StrListPipeFilter(StrListPipePtr pipeline, StrListFilterFunc filter_func, void *custom)
+{
+	return(VoidListPipeFilter(pipeline, (VoidListFilterFunc *)filter_func, custom));
+}
+
+int StrListPipeReduce(StrListPipePtr pipeline, StrListReduceFunc reduce_func, void **value, void *initial, void *custom)
+{
+	return(VoidListPipeReduce(pipeline, (VoidListReduceFunc *)reduce_func, value, initial, custom));
+}
+
+long StrListPipeFind(StrListPipePtr pipeline, char **value)
+{
+	return(VoidListPipeFind(pipeline, (void **)value));
+}
+
+/* String List callback functions */
+int strlist_alloc(VoidListPtr list, void **ptr, void *value, size_t width)
+{
+	return(voidlist_alloc(list, ptr, value, strlen(value) + 1));
+}
+
+void strlist_cpy(VoidListPtr list, void *dest, void *src, size_t width)
+{
+	strcpy(dest, src);
+}
+
+int strlist_cmp(VoidListPtr list, void *ptr1, void *ptr2, size_t width)
+{
+	return(strcmp(ptr1, ptr2));
+}
+
+int strlist_icmp(VoidListPtr list, void *ptr1, void *ptr2, size_t width)
+{
+	return(strcasecmp(ptr1, ptr2));
+}
+
+void *strlist_print(VoidListPtr list, long index, void *value, void *custom)
+{
+	fprintf(custom, "%s ", (char *)value);
+	return(value);
+}
+
+
+
+/*********************************
+ *  Front Coded String Functions
+ */
+
+/* Varint (7 bits per byte) prefix lengths; returns bytes used */
+size_t strfront_put_varint(unsigned char *ptr, size_t value)
+{
+	size_t n = 0;
+
+	do {
+		if(ptr)
+			ptr[n] = (value & 0x7F) | (value > 0x7F ? 0x80 : 0);
+		n++;
+		value >>= 7;
+	} while(value);
+
+	return(n);
+}
+
+size_t strfront_get_varint(unsigned char **ptr)
+{
+	size_t value = 0;
+	int shift = 0;
+
+	do {
+		value |= (size_t)(**ptr & 0x7F) << shift;
+		shift += 7;
+	} while(*(*ptr)++ & 0x80);
+
+	return(value);
+}
+
+size_t strfront_prefix(const char *a, const char *b)
+{
+	size_t n = 0;
+
+	while(a[n] && a[n] == b[n])
+		n++;
+
+	return(n);
+}
+
+/* Decodes element index into value, given ptr at its encoding (a bucket head when index is a multiple) */
+void strfront_next(StrFrontPtr front, unsigned char **ptr, unsigned long index, char *value)
+{
+	size_t prefix = 0, length;
+
+	if(index % STRFRONT_BUCKET)
+		prefix = strfront_get_varint(ptr);
+
+	length = strlen((char *)*ptr);
+	memcpy(value + prefix, *ptr, length + 1);
+	*ptr += length + 1;
+}
+
+/* First index whose string passes value: compares length bytes, past means > 0 when upper, else >= 0 */
+unsigned long strfront_bound(StrFrontPtr front, char *value, size_t length, int upper, char *tmp)
+{
+	unsigned long lo = 0, hi = front->buckets, mid, index, end;
+	unsigned char *ptr;
+	int cmp;
+
+	while(lo < hi) {
+		mid = (lo + hi) >> 1;
+		cmp = strncmp(front->data + front->bucket[mid], value, length);
+		if(cmp > 0 || (!upper && !cmp))
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+
+	if(!lo)
+		return(0);
+
+	/* The bound lies in the bucket before the first head past it */
+	index = (lo - 1) * STRFRONT_BUCKET;
+	end = index + STRFRONT_BUCKET < front->size ? index + STRFRONT_BUCKET : front->size;
+	ptr = (unsigned char *)front->data + front->bucket[lo - 1];
+	for(; index < end; index++) {
+		strfront_next(front, &ptr, index, tmp);
+		cmp = strncmp(tmp, value, length);
+		if(cmp > 0 || (!upper && !cmp))
+			break;
+	}
+
+	return(index);
+}
+
+/* Builds a read-only copy of a sorted list, storing each string as the prefix it shares with the one before */
+int StrListFrontCode(StrFrontPtr front, StrListPtr list)
+{
+	unsigned long size = list->ptr - list->start, i;
+	size_t bytes = 0, prefix, length;
+	unsigned char *ptr;
+	char **value = (char **)list->start;
+
+	front->data = NULL;
+	front->bucket = NULL;
+	front->size = front->buckets = front->bytes = front->longest = 0;
+
+	for(i = 0; i < size; i++) {
+		if(i && strcmp(value[i - 1], value[i]) > 0)
+			return(FALSE);
+
+		length = strlen(value[i]);
+		if(length > front->longest)
+			front->longest = length;
+
+		prefix = i % STRFRONT_BUCKET ? strfront_prefix(value[i - 1], value[i]) : 0;
+		bytes += (i % STRFRONT_BUCKET ? strfront_put_varint(NULL, prefix) : 0) + length - prefix + 1;
+	}
+
+	front->buckets = (size + STRFRONT_BUCKET - 1) / STRFRONT_BUCKET;
+	if((front->data = lists_malloc(bytes + 1)) == NULL
+			|| (front->bucket = lists_malloc((front->buckets + 1) * sizeof(unsigned long))) == NULL) {
+		StrFrontFree(front);
+		return(FALSE);
+	}
+
+	for(ptr = (unsigned char *)front->data, i = 0; i < size; i++) {
+		if(i % STRFRONT_BUCKET) {
+			prefix = strfront_prefix(value[i - 1], value[i]);
+			ptr += strfront_put_varint(ptr, prefix);
+		} else {
+			front->bucket[i / STRFRONT_BUCKET] = (char *)ptr - front->data;
+			prefix = 0;
+		}
+
+		length = strlen(value[i] + prefix) + 1;
+		memcpy(ptr, value[i] + prefix, length);
+		ptr += length;
+	}
+
+	front->size = size;
+	front->bytes = bytes;
+
+	return(TRUE);
+}
+
+void StrFrontFree(StrFrontPtr front)
+{
+	lists_free(front->data);
+	lists_free(front->bucket);
+
+	front->data = NULL;
+	front->bucket = NULL;
+	front->size = front->buckets = front->bytes = front->longest = 0;
+}
+
+long StrFrontSize(StrFrontPtr front)
+{
+	return(front->size);
+}
+
+size_t StrFrontBytes(StrFrontPtr front)
+{
+	return(front->bytes + front->buckets * sizeof(unsigned long));
+}
+
+/* Copies out one string, decoding at most a bucket; truncates and fails when size is too small */
+int StrFrontGet(StrFrontPtr front, long index, char *value, size_t size)
+{
+	unsigned long i;
+	unsigned char *ptr;
+	char *tmp;
+	size_t length;
+
+	if(index < 0)
+		index += front->size;
+
+	if(index < 0 || (unsigned long)index >= front->size || !size)
+		return(FALSE);
+
+	if((tmp = lists_malloc(front->longest + 1)) == NULL)
+		return(FALSE);
+
+	ptr = (unsigned char *)front->data + front->bucket[index / STRFRONT_BUCKET];
+	for(i = index - index % STRFRONT_BUCKET; i <= (unsigned long)index; i++)
+		strfront_next(front, &ptr, i, tmp);
+
+	if((length = strlen(tmp)) >= size) {
+		memcpy(value, tmp, size - 1);
+		value[size - 1] = 0;
+		lists_free(tmp);
+		return(FALSE);
+	}
+
+	memcpy(value, tmp, length + 1);
+	lists_free(tmp);
+
+	return(TRUE);
+}
+
+long StrFrontFind(StrFrontPtr front, char *value)
+{
+	unsigned long index;
+	char *tmp;
+
+	if(!front->size || (tmp = lists_malloc(front->longest + 1)) == NULL)
+		return(-1);
+
+	/* Comparing the terminator too makes this an exact lower bound */
+	index = strfront_bound(front, value, strlen(value) + 1, FALSE, tmp);
+	if(index < front->size && index % STRFRONT_BUCKET == 0)
+		StrFrontGet(front, index, tmp, front->longest + 1);
+
+	if(index >= front->size || strcmp(tmp, value))
+		index = -1;
+
+	lists_free(tmp);
+
+	return(index);
+}
+
+int StrFrontPrefix(StrFrontPtr front, char *prefix, long *first, long *count)
+{
+	unsigned long lo = 0, hi = 0;
+	size_t length = strlen(prefix);
+	char *tmp;
+
+	if(front->size && (tmp = lists_malloc(front->longest + 1)) != NULL) {
+		lo = strfront_bound(front, prefix, length, FALSE, tmp);
+		hi = strfront_bound(front, prefix, length, TRUE, tmp);
+		lists_free(tmp);
+	}
+
+	if(first)
+		*first = lo;
+
+	if(count)
+		*count = hi - lo;
+
+	return(hi > lo);
+}
+
+/* Calls func for each string starting with prefix (all of them for NULL) in order, until it returns FALSE */
+int StrFrontIterate(StrFrontPtr front, char *prefix, StrFrontIterateFunc func, void *custom)
+{
+	long first = 0, count = front->size;
+	unsigned long index, end;
+	unsigned char *ptr;
+	char *tmp;
+
+	if(prefix && !StrFrontPrefix(front, prefix, &first, &count))
+		return(TRUE);
+
+	if(!count)
+		return(TRUE);
+
+	if((tmp = lists_malloc(front->longest + 1)) == NULL)
+		return(FALSE);
+
+	/* Decode from the head of the first bucket, reporting only from first on */
+	index = first - first % STRFRONT_BUCKET;
+	end = first + count;
+	ptr = (unsigned char *)front->data + front->bucket[index / STRFRONT_BUCKET];
+	for(; index < end; index++) {
+		if(index % STRFRONT_BUCKET == 0)
+			ptr = (unsigned char *)front->data + front->bucket[index / STRFRONT_BUCKET];
+		strfront_next(front, &ptr, index, tmp);
+		if(index >= (unsigned long)first && !func(front, index, tmp, custom))
+			break;
+	}
+
+	lists_free(tmp);
+
+	return(TRUE);
+}
+
+
+
+/****************************
+ *  External sort functions
+ */
+#define LISTS_EXTERNAL_MIN		65536	/* smallest memory budget, in bytes */
+#define LISTS_EXTERNAL_IO		1048576	/* preferred read buffer per run */
+#define LISTS_EXTERNAL_FANIN	256		/* most runs merged in one pass */
+
+struct ListsExternalStruct;
+typedef int (ListsExternalCmpFunc)(const char *record1, const char *record2);
+
+/* One sorted run being read back: records are fixed-width, or a 32 bit length then a NUL terminated string */
+typedef struct {
+	FILE *file;
+	char *buffer;
+	size_t size;
+	size_t start;
+	size_t end;
+	char *record;
+	size_t length;
+	int done;
+} ListsRunType;
+typedef ListsRunType *ListsRunPtr;
+
+/* Shared state of one external sort */
+typedef struct ListsExternalStruct {
+	size_t fixed;				/* record width, 0 for strings */
+	ListsExternalCmpFunc *cmp_func;
+	int flags;
+	IntListConsumeFunc *int_func;
+	StrListConsumeFunc *str_func;
+	void *custom;
+	ListsWriterPtr output;		/* final output when there is no consumer */
+	FILE **run;
+	unsigned long runs;
+	unsigned long reserve;
+	size_t memory;
+	char *last;					/* last record emitted, for LISTS_EXTERNAL_UNIQUE */
+	size_t last_size;
+	int has_last;
+} ListsExternalType;
+typedef ListsExternalType *ListsExternalPtr;
+
+int lists_external_cmp_long(const char *record1, const char *record2)
+{
+	long a, b;
+
+	memcpy(&a, record1, sizeof(long));
+	memcpy(&b, record2, sizeof(long));
+
+	return((a > b) - (a < b));
+}
+
+int lists_external_cmp_str(const char *record1, const char *record2)
+{
+	return(strcmp(record1, record2));
+}
+
+ListsWriterPtr lists_external_writer(FILE *stream)
+{
+	ListsWriterPtr writer;
+
+	if((writer = lists_malloc(sizeof(ListsWriterType))) == NULL)
+		return(NULL);
+
+	writer->stream = stream;
+	writer->error = FALSE;
+	writer->used = 0;
+
+	return(writer);
+}
+
+/* Sends one record to a run (writer), or to the caller when writer is NULL */
+int lists_external_emit(ListsExternalPtr job, ListsWriterPtr writer, const char *record, size_t length)
+{
+	uint32_t size = length;
+	long value;
+	char *last;
+
+	if(job->flags & LISTS_EXTERNAL_UNIQUE) {
+		if(job->has_last && !job->cmp_func(job->last, record))
+			return(TRUE);
+		if(length > job->last_size) {
+			if((last = lists_realloc(job->last, length * 2)) == NULL)
+				return(FALSE);
+			job->last = last;
+			job->last_size = length * 2;
+		}
+		memcpy(job->last, record, length);
+		job->has_last = TRUE;
+	}
+
+	if(writer) {
+		if(!job->fixed)
+			lists_writer_put(writer, (char *)&size, sizeof(size));
+		lists_writer_put(writer, record, length);
+		return(!writer->error);
+	}
+
+	if(job->fixed) {
+		if(job->int_func) {
+			memcpy(&value, record, sizeof(long));
+			return(job->int_func(value, job->custom));
+		}
+		lists_writer_put(job->output, record, length);
+	} else {
+		if(job->str_func)
+			return(job->str_func((char *)record, job->custom));
+		lists_writer_put(job->output, record, length - 1);
+		lists_writer_put(job->output, "\n", 1);
+	}
+
+	return(!job->output->error);
+}
+
+/* Spills a sorted run of records to a new temporary file */
+int lists_external_spill(ListsExternalPtr job, char **record, char *records, unsigned long count)
+{
+	ListsWriterPtr writer;
+	FILE **run, *file;
+	unsigned long i;
+	int result;
+
+	if(job->runs == job->reserve) {
+		if((run = lists_realloc(job->run, (job->reserve * 2 + 16) * sizeof(FILE *))) == NULL)
+			return(FALSE);
+		job->run = run;
+		job->reserve = job->reserve * 2 + 16;
+	}
+
+	if((file = tmpfile()) == NULL)
+		return(FALSE);
+
+	if((writer = lists_external_writer(file)) == NULL) {
+		fclose(file);
+		return(FALSE);
+	}
+
+	job->has_last = FALSE;
+	if(records && !(job->flags & LISTS_EXTERNAL_UNIQUE))
+		lists_writer_put(writer, records, count * job->fixed);
+	else
+		for(i = 0; i < count; i++)
+			if(!lists_external_emit(job, writer, records ? records + i * job->fixed : record[i],
+					records ? job->fixed : strlen(record[i]) + 1))
+				break;
+
+	result = lists_writer_flush(writer, NULL, 0) && fflush(file) == 0;
+	lists_free(writer);
+	job->run[job->runs++] = file;
+
+	return(result);
+}
+
+/* Makes sure length unread bytes are buffered, refilling from the file */
+int lists_run_fill(ListsRunPtr run, size_t length)
+{
+	char *buffer;
+
+	if(run->end - run->start >= length)
+		return(TRUE);
+
+	memmove(run->buffer, run->buffer + run->start, run->end - run->start);
+	run->end -= run->start;
+	run->start = 0;
+
+	if(length > run->size) {
+		if((buffer = lists_realloc(run->buffer, length)) == NULL)
+			return(FALSE);
+		run->buffer = buffer;
+		run->size = length;
+	}
+
+	run->end += fread(run->buffer + run->end, 1, run->size - run->end, run->file);
+
+	return(run->end >= length);
+}
+
+void lists_run_next(ListsExternalPtr job, ListsRunPtr run)
+{
+	uint32_t length;
+
+	if(!lists_run_fill(run, job->fixed ? job->fixed : sizeof(length))) {
+		run->done = TRUE;
+		return;
+	}
+
+	if(job->fixed)
+		length = job->fixed;
+	else {
+		memcpy(&length, run->buffer + run->start, sizeof(length));
+		run->start += sizeof(length);
+		if(!lists_run_fill(run, length)) {
+			run->done = TRUE;
+			return;
+		}
+	}
+
+	run->record = run->buffer + run->start;
+	run->length = length;
+	run->start += length;
+}
+
+/* Loser tree order: index count is the minus infinity used to build, finished runs are plus infinity */
+int lists_run_less(ListsExternalPtr job, ListsRunPtr run, unsigned long count, unsigned long a, unsigned long b)
+{
+	int cmp;
+
+	if(a == count || b == count)
+		return(a == count);
+
+	if(run[a].done || run[b].done)
+		return(!run[a].done);
+
+	cmp = job->cmp_func(run[a].record, run[b].record);
+
+	return(cmp < 0 || (!cmp && a < b));
+}
+
+void lists_run_adjust(ListsExternalPtr job, ListsRunPtr run, unsigned long *tree, unsigned long count, unsigned long s)
+{
+	unsigned long t, tmp;
+
+	for(t = (s + count) / 2; t > 0; t /= 2)
+		if(lists_run_less(job, run, count, tree[t], s)) {
+			tmp = tree[t];
+			tree[t] = s;
+			s = tmp;
+		}
+
+	tree[0] = s;
+}
+
+/* Merges count runs from job->run + first into writer, or to the caller when writer is NULL */
+int lists_external_merge(ListsExternalPtr job, unsigned long first, unsigned long count, ListsWriterPtr writer)
+{
+	ListsRunPtr run;
+	unsigned long *tree, i, w;
+	size_t size = job->memory / (count + 1);
+	int result = TRUE;
+
+	run = lists_calloc(count, sizeof(ListsRunType));
+	tree = lists_malloc(count * sizeof(unsigned long));
+	if(!run || !tree) {
+		lists_free(run);
+		lists_free(tree);
+		return(FALSE);
+	}
+
+	if(size > LISTS_EXTERNAL_IO)
+		size = LISTS_EXTERNAL_IO;
+
+	for(i = 0; i < count; i++) {
+		run[i].file = job->run[first + i];
+		rewind(run[i].file);
+		run[i].size = size;
+		if((run[i].buffer = lists_malloc(size)) == NULL)
+			result = FALSE;
+		else
+			lists_run_next(job, run + i);
+	}
+
+	if(result) {
+		for(i = 0; i < count; i++)
+			tree[i] = count;
+		for(i = count; i--; )
+			lists_run_adjust(job, run, tree, count, i);
+
+		job->has_last = FALSE;
+		while(!run[w = tree[0]].done) {
+			if(!lists_external_emit(job, writer, run[w].record, run[w].length)) {
+				result = FALSE;
+				break;
+			}
+			lists_run_next(job, run + w);
+			lists_run_adjust(job, run, tree, count, w);
+		}
+	}
+
+	for(i = 0; i < count; i++) {
+		lists_free(run[i].buffer);
+		fclose(run[i].file);
+	}
+	lists_free(run);
+	lists_free(tree);
+
+	return(result);
+}
+
+/* Merges runs in passes of at most fanin until one pass can feed the output */
+int lists_external_finish(ListsExternalPtr job)
+{
+	ListsWriterPtr writer;
+	unsigned long fanin = job->memory / LISTS_EXTERNAL_IO, first, count, runs;
+	FILE *file;
+
+	if(fanin < 2)
+		fanin = 2;
+	if(fanin > LISTS_EXTERNAL_FANIN)
+		fanin = LISTS_EXTERNAL_FANIN;
+
+	while(job->runs > fanin) {
+		for(first = 0, runs = 0; first < job->runs; first += count) {
+			count = job->runs - first < fanin ? job->runs - first : fanin;
+			writer = NULL;
+			if((file = tmpfile()) == NULL || (writer = lists_external_writer(file)) == NULL
+					|| !lists_external_merge(job, first, count, writer) || !lists_writer_flush(writer, NULL, 0)) {
+				/* A merge closes its runs even when it fails; keep the rest for lists_external_free */
+				if(writer)
+					first += count;
+				memmove(job->run + runs, job->run + first, (job->runs - first) * sizeof(FILE *));
+				job->runs = runs + job->runs - first;
+				lists_free(writer);
+				if(file)
+					fclose(file);
+				return(FALSE);
+			}
+			lists_free(writer);
+			/* Merged runs are closed, so their slots can hold the new ones */
+			job->run[runs++] = file;
+		}
+		job->runs = runs;
+	}
+
+	count = job->runs;
+	job->runs = 0;
+
+	return(lists_external_merge(job, 0, count, NULL));
+}
+
+int lists_external_init(ListsExternalPtr job, size_t memory, int flags, void *out)
+{
+	job->memory = memory < LISTS_EXTERNAL_MIN ? LISTS_EXTERNAL_MIN : memory;
+	job->flags = flags;
+	job->custom = out;
+	job->output = NULL;
+	job->run = NULL;
+	job->runs = job->reserve = 0;
+	job->last = NULL;
+	job->last_size = 0;
+	job->has_last = FALSE;
+
+	return(TRUE);
+}
+
+int lists_external_free(ListsExternalPtr job, int result)
+{
+	unsigned long i;
+
+	for(i = 0; i < job->runs; i++)
+		fclose(job->run[i]);
+
+	if(job->output) {
+		if(!lists_writer_flush(job->output, NULL, 0))
+			result = FALSE;
+		lists_free(job->output);
+	}
+
+	lists_free(job->run);
+	lists_free(job->last);
+
+	return(result);
+}
+
+/* Sorts more longs than fit in memory, spilling sorted runs to temporary files */
+int IntListExternalSort(IntListProduceFunc produce_func, void *in, IntListConsumeFunc consume_func, void *out,
+		size_t memory, int flags)
+{
+	ListsExternalType job;
+	IntListType run;
+	unsigned long capacity, count;
+	long *values;
+	int more = TRUE, result = TRUE;
+	size_t n;
+
+	lists_external_init(&job, memory, flags, out);
+	job.fixed = sizeof(long);
+	job.cmp_func = lists_external_cmp_long;
+	job.int_func = consume_func;
+	job.str_func = NULL;
+
+	/* The sort takes a scratch copy of the run, so a run gets half the budget */
+	capacity = job.memory / (2 * sizeof(long));
+	if(!IntListInit(&run, capacity, capacity))
+		return(FALSE);
+	if(!consume_func && (job.output = lists_external_writer(out)) == NULL) {
+		IntListFree(&run);
+		return(FALSE);
+	}
+
+	values = run.start;
+	while(more && result) {
+		for(count = 0; count < capacity; count += n)
+			if(produce_func) {
+				if(!(more = produce_func(values + count, in)))
+					break;
+				n = 1;
+			} else if(!(more = (n = fread(values + count, sizeof(long), capacity - count, in)) > 0))
+				break;
+
+		run.ptr = values + count;
+		IntListSortParallel(&run, 0);
+
+		/* Everything fit in one run: no files needed */
+		if(!more && !job.runs) {
+			job.has_last = FALSE;
+			for(n = 0; n < count && result; n++)
+				result = lists_external_emit(&job, NULL, (char *)(values + n), sizeof(long));
+			IntListFree(&run);
+			return(lists_external_free(&job, result));
+		}
+
+		if(count)
+			result = lists_external_spill(&job, NULL, (char *)values, count);
+	}
+
+	IntListFree(&run);
+
+	if(result)
+		result = lists_external_finish(&job);
+
+	return(lists_external_free(&job, result));
+}
+
+/* Sorts count string pointers, with the arena space right after them as the sort's scratch */
+int strlist_external_sort(VoidListPtr run, char **record, unsigned long count)
+{
+	ListsSortType job;
+
+	job.start = (char *)record;
+	job.tmp = (char *)(record + count);
+	job.size = count;
+	job.width = sizeof(char *);
+	job.threads = lists_threads(0);
+	job.cmp_func = lists_sort_void;
+	job.list = run;
+
+	return(lists_sort_tmp(&job));
+}
+
+/* Sorts more strings than fit in memory; FILEs hold one string per line */
+int StrListExternalSort(StrListProduceFunc produce_func, void *in, StrListConsumeFunc consume_func, void *out,
+		size_t memory, int flags)
+{
+	ListsExternalType job;
+	StrListType run;
+	char *arena, **record, *value, *line = NULL;
+	size_t arena_size, used = 0, length, line_size = 0;
+	unsigned long count = 0, i;
+	ssize_t n;
+	int result = TRUE;
+
+	lists_external_init(&job, memory, flags, out);
+	job.fixed = 0;
+	job.cmp_func = lists_external_cmp_str;
+	job.int_func = NULL;
+	job.str_func = consume_func;
+
+	/* Pointers fill the arena from the bottom, with room for the sort's scratch copy after them; strings fill it from the top */
+	arena_size = job.memory;
+	if((record = (char **)(arena = lists_malloc(arena_size))) == NULL)
+		return(FALSE);
+	/* The list only carries the comparison for the sort */
+	if(!VoidListInit(&run, 0, 0, 0, NULL, NULL, NULL, strlist_cmp)
+			|| (!consume_func && (job.output = lists_external_writer(out)) == NULL)) {
+		lists_free(arena);
+		return(FALSE);
+	}
+
+	for(;;) {
+		if(produce_func)
+			value = produce_func(in);
+		else if((n = getline(&line, &line_size, in)) >= 0) {
+			if(n && line[n - 1] == '\n')
+				line[n - 1] = 0;
+			value = line;
+		} else
+			value = NULL;
+
+		length = value ? strlen(value) + 1 : 0;
+
+		/* Spill when the strings, their pointers and the scratch would pass the budget */
+		if(!value || used + length + (count + 1) * 2 * sizeof(char *) > job.memory) {
+			if(!value && !job.runs)
+				break;
+			if(count) {
+				if(!(result = strlist_external_sort(&run, record, count))
+						|| !(result = lists_external_spill(&job, record, NULL, count)))
+					break;
+				count = used = 0;
+			}
+			if(!value)
+				break;
+		}
+
+		/* A string larger than the whole budget gets a run to itself */
+		if(length + 2 * sizeof(char *) > arena_size) {
+			lists_free(arena);
+			arena_size = length + 2 * sizeof(char *);
+			if((record = (char **)(arena = lists_malloc(arena_size))) == NULL) {
+				result = FALSE;
+				break;
+			}
+		}
+
+		used += length;
+		memcpy(record[count++] = arena + arena_size - used, value, length);
+	}
+
+	free(line);
+
+	if(result && !job.runs && (result = strlist_external_sort(&run, record, count))) {
+		job.has_last = FALSE;
+		for(i = 0; i < count && result; i++)
+			result = lists_external_emit(&job, NULL, record[i], strlen(record[i]) + 1);
+	}
+
+	/* The merge buffers take the whole budget, so the run goes first */
+	VoidListFree(&run);
+	lists_free(arena);
+
+	if(result && job.runs)
+		result = lists_external_finish(&job);
+
+	return(lists_external_free(&job, result));
+}
+
+
+/**************************
+ *  String Map Functions
+ */
+int StrMapInit(StrMapPtr map, unsigned long reserve)
+{
+	unsigned long size = 16;
+
+	while(size * 4 < reserve * 5)
+		size <<= 1;
+
+	if((map->entry = lists_calloc(size, sizeof(StrMapEntryType))) == NULL)
+		return(FALSE);
+
+	map->size = size;
+	map->count = 0;
+	map->arena = NULL;
+	map->arena_size = 0;
+	map->arena_used = 0;
+	map->arena_dead = 0;
+	memset(&map->payload, 0, sizeof(VoidListType));
+
+	return(TRUE);
+}
+
+int StrMapInitPayload(StrMapPtr map, unsigned long reserve, size_t width,
+		VoidListAllocFunc alloc_func, VoidListFreeFunc free_func, VoidListCpyFunc cpy_func)
+{
+	if(!StrMapInit(map, reserve))
+		return(FALSE);
+
+	map->payload.width = width;
+	map->payload.alloc_func = alloc_func ? alloc_func : voidlist_alloc;
+	map->payload.free_func = free_func ? free_func : voidlist_free;
+	map->payload.cpy_func = cpy_func ? cpy_func : voidlist_cpy;
+
+	return(TRUE);
+}
+
+void StrMapFree(StrMapPtr map)
+{
+	unsigned long i;
+
+	if(map->payload.alloc_func)
+		for(i = 0; i < map->size; i++)
+			if(map->entry[i].distance)
+				map->payload.free_func(&map->payload, map->entry[i].payload);
+
+	lists_free(map->entry);
+	lists_free(map->arena);
+
+	map->entry = NULL;
+	map->size = 0;
+	map->count = 0;
+	map->arena = NULL;
+	map->arena_size = map->arena_used = map->arena_dead = 0;
+	memset(&map->payload, 0, sizeof(VoidListType));
+}
+
+long StrMapSize(StrMapPtr map)
+{
+	return(map->count);
+}
+
+unsigned long strmap_hash(char *key, size_t *length)
+{
+	return(lists_hash_long(lists_hash(key, length)));
+}
+
+/* Slot holding key, or -1; Robin Hood order ends the probe at the first poorer entry */
+long strmap_find(StrMapPtr map, char *key)
+{
+	unsigned long mask = map->size - 1, hash, slot;
+	unsigned int distance;
+	size_t length;
+	StrMapEntryPtr entry;
+
+	hash = strmap_hash(key, &length);
+
+	for(slot = hash & mask, distance = 1;; slot = (slot + 1) & mask, distance++) {
+		entry = map->entry + slot;
+		if(entry->distance < distance)
+			return(-1);
+		if(entry->hash == hash && entry->length == length && !memcmp(map->arena + entry->key, key, length))
+			return(slot);
+	}
+}
+
+/* Places an entry, displacing richer ones further along */
+void strmap_place(StrMapPtr map, StrMapEntryType entry)
+{
+	unsigned long mask = map->size - 1, slot;
+	StrMapEntryType swap;
+
+	entry.distance = 1;
+	for(slot = entry.hash & mask;; slot = (slot + 1) & mask, entry.distance++) {
+		if(!map->entry[slot].distance) {
+			map->entry[slot] = entry;
+			return;
+		}
+		if(map->entry[slot].distance < entry.distance) {
+			swap = map->entry[slot];
+			map->entry[slot] = entry;
+			entry = swap;
+		}
+	}
+}
+
+/* Rebuilds the table at size slots, packing live keys to the front of the arena */
+int strmap_rehash(StrMapPtr map, unsigned long size)
+{
+	StrMapEntryType *old = map->entry;
+	unsigned long old_size = map->size, i, used = 0;
+	char *arena = NULL;
+
+	if((map->entry = lists_calloc(size, sizeof(StrMapEntryType))) == NULL) {
+		map->entry = old;
+		return(FALSE);
+	}
+
+	if(map->arena_dead && (arena = lists_malloc(map->arena_size)) == NULL) {
+		lists_free(map->entry);
+		map->entry = old;
+		return(FALSE);
+	}
+
+	map->size = size;
+	for(i = 0; i < old_size; i++)
+		if(old[i].distance) {
+			if(arena) {
+				memcpy(arena + used, map->arena + old[i].key, old[i].length + 1);
+				old[i].key = used;
+				used += old[i].length + 1;
+			}
+			strmap_place(map, old[i]);
+		}
+
+	if(arena) {
+		lists_free(map->arena);
+		map->arena = arena;
+		map->arena_used = used;
+		map->arena_dead = 0;
+	}
+
+	lists_free(old);
+
+	return(TRUE);
+}
+
+/* Finds or adds key, returning its slot or -1 when out of memory */
+long strmap_slot(StrMapPtr map, char *key, int *added)
+{
+	StrMapEntryType entry;
+	unsigned long size;
+	size_t length;
+	long slot;
+	char *arena;
+
+	*added = FALSE;
+
+	if((slot = strmap_find(map, key)) >= 0)
+		return(slot);
+
+	/* Double at 80% load; a full arena that is half deleted keys is packed instead of grown */
+	if((map->count + 1) * 5 >= map->size * 4 && !strmap_rehash(map, map->size * 2))
+		return(-1);
+
+	entry.hash = strmap_hash(key, &length);
+	entry.length = length;
+
+	if(map->arena_used + length + 1 > map->arena_size && map->arena_dead * 2 > map->arena_used)
+		if(!strmap_rehash(map, map->size))
+			return(-1);
+
+	if(map->arena_used + length + 1 > map->arena_size) {
+		for(size = map->arena_size ? map->arena_size : 256; size < map->arena_used + length + 1; size <<= 1);
+		if((arena = lists_realloc(map->arena, size)) == NULL)
+			return(-1);
+		map->arena = arena;
+		map->arena_size = size;
+	}
+
+	entry.key = map->arena_used;
+	memcpy(map->arena + map->arena_used, key, length + 1);
+	map->arena_used += length + 1;
+
+	entry.value = 0;
+	entry.payload = NULL;
+	strmap_place(map, entry);
+	map->count++;
+	*added = TRUE;
+
+	return(strmap_find(map, key));
+}
+
+int StrMapPut(StrMapPtr map, char *key, long value)
+{
+	long slot;
+	int added;
+
+	if((slot = strmap_slot(map, key, &added)) < 0)
+		return(FALSE);
+
+	map->entry[slot].value = value;
+
+	return(TRUE);
+}
+
+int StrMapGet(StrMapPtr map, char *key, long *value)
+{
+	long slot;
+
+	if((slot = strmap_find(map, key)) < 0)
+		return(FALSE);
+
+	if(value)
+		*value = map->entry[slot].value;
+
+	return(TRUE);
+}
+
+int StrMapPutValue(StrMapPtr map, char *key, void *value)
+{
+	StrMapEntryPtr entry;
+	void *payload;
+	long slot;
+	int added;
+
+	if(!map->payload.alloc_func || (slot = strmap_slot(map, key, &added)) < 0)
+		return(FALSE);
+
+	entry = map->entry + slot;
+
+	/* The old payload goes only once the new one exists; a failed update leaves the entry as it was */
+	if(!map->payload.alloc_func(&map->payload, &payload, value, map->payload.width)) {
+		if(added) {
+			entry->payload = NULL;
+			StrMapDelete(map, key);
+		}
+		return(FALSE);
+	}
+
+	if(!added)
+		map->payload.free_func(&map->payload, entry->payload);
+	entry->payload = payload;
+
+	return(TRUE);
+}
+
+int StrMapGetValue(StrMapPtr map, char *key, void *value)
+{
+	void *payload;
+
+	if((payload = StrMapPointer(map, key)) == NULL)
+		return(FALSE);
+
+	if(value)
+		map->payload.cpy_func(&map->payload, value, payload, map->payload.width);
+
+	return(TRUE);
+}
+
+void *StrMapPointer(StrMapPtr map, char *key)
+{
+	long slot;
+
+	if(!map->payload.alloc_func || (slot = strmap_find(map, key)) < 0)
+		return(NULL);
+
+	return(map->entry[slot].payload);
+}
+
+/* Backward shift deletion: later entries of the same run move up a slot */
+int StrMapDelete(StrMapPtr map, char *key)
+{
+	unsigned long mask = map->size - 1, slot, next;
+	long found;
+
+	if((found = strmap_find(map, key)) < 0)
+		return(FALSE);
+
+	slot = found;
+	if(map->payload.alloc_func && map->entry[slot].payload)
+		map->payload.free_func(&map->payload, map->entry[slot].payload);
+	map->arena_dead += map->entry[slot].length + 1;
+
+	for(next = (slot + 1) & mask; map->entry[next].distance > 1; slot = next, next = (next + 1) & mask) {
+		map->entry[slot] = map->entry[next];
+		map->entry[slot].distance--;
+	}
+	map->entry[slot].distance = 0;
+	map->count--;
+
+	return(TRUE);
+}
+
+int StrMapIterate(StrMapPtr map, StrMapIterFunc iter_func, void *custom)
+{
+	StrMapEntryPtr entry;
+	unsigned long i;
+
+	for(i = 0; i < map->size; i++)
+		if((entry = map->entry + i)->distance
+				&& !iter_func(map, map->arena + entry->key, entry->value, entry->payload, custom))
+			return(FALSE);
+
+	return(TRUE);
+}
+
+int StrMapKeys(StrMapPtr map, StrListPtr keys)
+{
+	unsigned long i;
+
+	for(i = 0; i < map->size; i++)
+		if(map->entry[i].distance && !StrListPush(keys, map->arena + map->entry[i].key))
+			return(FALSE);
+
+	return(TRUE);
+}
+
+int StrMapValues(StrMapPtr map, IntListPtr values)
+{
+	unsigned long i;
+
+	if(map->payload.alloc_func)
+		return(FALSE);
+
+	for(i = 0; i < map->size; i++)
+		if(map->entry[i].distance && !IntListPush(values, map->entry[i].value))
+			return(FALSE);
+
+	return(TRUE);
+}
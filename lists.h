@@ -37,27 +37,83 @@
 #endif
 
 
-/* Int List structures */
+/* Default elements prefetched ahead by Void List scans */
+#define LISTS_PREFETCH		8
+
+/* List buffer policy (applies to buffers allocated or grown afterwards) */
+void ListsSetAlign(size_t align);
+void ListsSetHugePage(size_t threshold);
+void ListsSetPrefetch(unsigned long distance);	/* payloads fetched ahead in Void List scans, 0 for none */
+void *lists_buffer_realloc(void *buffer, size_t size);
+void lists_buffer_free(void *buffer);
+
+/* List allocator hooks (set before anything is allocated; NULL restores the C library) */
+typedef void *(ListsMallocFunc)(size_t size);
+typedef void *(ListsReallocFunc)(void *ptr, size_t size);
+typedef void (ListsFreeFunc)(void *ptr);
+
+void ListsSetAllocator(ListsMallocFunc *malloc_func, ListsReallocFunc *realloc_func, ListsFreeFunc *free_func);
+void *lists_malloc(size_t size);
+void *lists_calloc(size_t count, size_t size);
+void *lists_realloc(void *ptr, size_t size);
+void lists_free(void *ptr);
+
+/* List memory accounting (list buffer bytes; a budget of 0 means no limit) */
+void ListsSetBudget(size_t bytes);
+size_t ListsBytes(void);
+int ListsUnregister(void *list);
+size_t ListsTrimAll(void);	/* shrinks every registered list to fit, returns bytes released */
+
+
+/* List tracing operations */
+#define LISTS_OP_RESERVE	0
+#define LISTS_OP_REMOVE		1
+#define LISTS_OP_FILTER		2
+#define LISTS_OP_ROTATE		3
+#define LISTS_OP_COPY		4
+#define LISTS_OP_ALLOC		5
+#define LISTS_OP_FREE		6
+#define LISTS_OPS			7
+#define LISTS_HISTOGRAM_BUCKETS	64
+
+/* List latency histograms (log2 buckets of ns per call, off until enabled) */
+void ListsHistogramEnable(int enable);
+void ListsHistogramReset(void);
+int ListsHistogramGet(int op, unsigned long *counts);	/* LISTS_HISTOGRAM_BUCKETS counts */
+void ListsHistogramDump(FILE *stream);
+
+/* Int List structures (elements are stored in width-byte lanes: 1, 2, 4 or sizeof(long)) */
 typedef struct {
-	long *start;
-	long *ptr;
+	void *start;
+	void *ptr;
 	long reserve;
 	long grow;
 	size_t width;
+	size_t shift;	/* log2(width), so sizes shift instead of divide */
+	size_t budget;
 } IntListType;
 typedef IntListType *IntListPtr;
 
 /* Int List functions */
 int IntListInit(IntListPtr list, long reserve, long grow);
+int IntListInitWidth(IntListPtr list, long reserve, long grow, size_t width);
 void IntListFree(IntListPtr list);
 void IntListDump(IntListPtr list, FILE *stream, int type);
 int IntListReserve(IntListPtr list, unsigned long size, unsigned long grow);
+int IntListWiden(IntListPtr list, size_t width);
+int IntListReserveAddress(IntListPtr list, unsigned long size);	/* pointers stay valid up to size elements */
+int IntListSetBudget(IntListPtr list, size_t bytes);
+size_t IntListBytes(IntListPtr list);
+int IntListTrim(IntListPtr list);
+int IntListRegister(IntListPtr list);	/* for ListsTrimAll, until IntListFree */
 long IntListSize(IntListPtr list);
 int IntListRemove(IntListPtr list, long index, unsigned long size);
 int IntListResize(IntListPtr list, unsigned long size, long value);
+int IntListResizeUninit(IntListPtr list, unsigned long size);	/* new elements are unset */
+long *IntListAppendSpace(IntListPtr list, unsigned long count);	/* widens to long, new elements are unset */
 int IntListPush(IntListPtr list, long value);
 int IntListPop(IntListPtr list, long *value);
-long *IntListPointer(IntListPtr list, long index);
+long *IntListPointer(IntListPtr list, long index);	/* NULL unless width == sizeof(long) */
 int IntListSet(IntListPtr list, long index, long value);
 int IntListGet(IntListPtr list, long index, long *value);
 long IntListFind(IntListPtr list, long value);
@@ -65,6 +121,49 @@ int IntListReverse(IntListPtr list, long index, unsigned long size);
 int IntListRotate(IntListPtr list, long amount, long index, unsigned long size);
 int IntListCopy(IntListPtr dest, IntListPtr src, long index, unsigned long size);
 int IntListMove(IntListPtr dest, IntListPtr src, long index, unsigned long size);
+int IntListRemoveIndices(IntListPtr list, IntListPtr indices);
+int IntListSwapRemove(IntListPtr list, long index);
+
+/* Int List sorting functions (ascending; threads of 0 means one per CPU) */
+int IntListSort(IntListPtr list);
+int IntListSortParallel(IntListPtr list, int threads);
+int IntListUniqueParallel(IntListPtr list, int threads);	/* sorts, then drops duplicates */
+
+/* External sort callbacks (producers return FALSE when done, consumers return FALSE to stop) */
+typedef int (IntListProduceFunc)(long *value, void *custom);
+typedef int (IntListConsumeFunc)(long value, void *custom);
+
+/* External sort flags */
+#define LISTS_EXTERNAL_UNIQUE	1
+
+/* Int List external sort (runs plus their sort scratch fit in memory bytes and spill to temporary files; NULL callbacks mean in/out are FILEs of native longs) */
+int IntListExternalSort(IntListProduceFunc produce_func, void *in, IntListConsumeFunc consume_func, void *out,
+		size_t memory, int flags);
+
+/* Int List set functions (sorted, duplicate-free inputs; dest is overwritten and must differ) */
+int IntListUnion(IntListPtr dest, IntListPtr a, IntListPtr b);
+int IntListIntersect(IntListPtr dest, IntListPtr a, IntListPtr b);
+int IntListDifference(IntListPtr dest, IntListPtr a, IntListPtr b);
+int IntListSymDiff(IntListPtr dest, IntListPtr a, IntListPtr b);
+int IntListIntersectMany(IntListPtr dest, IntListPtr *lists, int count);	/* reorders lists by size */
+
+/* Int List distinct value functions (hash based, first-seen order; expect of 0 grows the table) */
+unsigned long IntListEstimate(IntListPtr list);	/* approximate distinct count */
+int IntListUnique(IntListPtr list, unsigned long expect);
+int IntListCount(IntListPtr list, IntListPtr values, IntListPtr counts, unsigned long expect);
+
+/* Heap flags (min-ordered binary heap by default) */
+#define LISTS_HEAP_MIN		0
+#define LISTS_HEAP_MAX		1
+#define LISTS_HEAP_4ARY		2
+
+/* Int List heap functions (the top sits at index 0; pass the same flags to every call) */
+int IntListHeapify(IntListPtr list, int flags);
+int IntListHeapPush(IntListPtr list, long value, int flags);
+int IntListHeapPop(IntListPtr list, long *value, int flags);
+int IntListHeapReplace(IntListPtr list, long value, long *top, int flags);
+int IntListHeapPeek(IntListPtr list, long *value);
+int IntListPartialSort(IntListPtr list, unsigned long k, int flags);	/* first k sorted, smallest first (largest with LISTS_HEAP_MAX), the rest unordered */
 
 /* Int List mapping callback functions */
 typedef long (IntListMapFunc)(IntListPtr list, long index, long value, void *custom);
@@ -75,9 +174,202 @@ typedef long (IntListReduceFunc)(IntListPtr list, long x, long value, void *cust
 int IntListMap(IntListPtr list, IntListMapFunc map_func, void *custom);
 int IntListFilter(IntListPtr list, IntListFilterFunc filter_func, void *custom);
 int IntListReduce(IntListPtr list, IntListReduceFunc reduce_func, long *value, long initial, void *custom);
+int IntListRemoveIf(IntListPtr list, IntListFilterFunc remove_func, void *custom);
+
+/* Block callback functions (one call per run of up to block elements; filters set keep[] and return the kept count) */
+#define LISTS_BLOCK		256
+
+typedef void (IntListMapBlockFunc)(IntListPtr list, long index, long *values, unsigned long count, void *custom);
+typedef unsigned long (IntListFilterBlockFunc)(IntListPtr list, long *values, unsigned char *keep, unsigned long count, void *custom);
+typedef long (IntListReduceBlockFunc)(IntListPtr list, long x, long *values, unsigned long count, void *custom);
+
+/* Int List block mapping functions (blocks run front to back; block of 0 means LISTS_BLOCK) */
+int IntListMapBlock(IntListPtr list, IntListMapBlockFunc map_func, unsigned long block, void *custom);
+int IntListFilterBlock(IntListPtr list, IntListFilterBlockFunc filter_func, unsigned long block, void *custom);
+int IntListReduceBlock(IntListPtr list, IntListReduceBlockFunc reduce_func, unsigned long block, long *value, long initial, void *custom);
 
 void IntListPrint(IntListPtr list, FILE *stream, IntListMapFunc func);
 
+/* Int List text functions (each element is written in decimal followed by delimiter) */
+int IntListWrite(IntListPtr list, FILE *stream, char delimiter);
+int IntListWriteFd(IntListPtr list, int fd, char delimiter);
+int IntListParse(IntListPtr list, const char *buffer, size_t length);	/* appends */
+
+/* List pipeline stage types */
+#define LISTS_PIPE_MAX		16
+#define LISTS_PIPE_MAP		0
+#define LISTS_PIPE_FILTER	1
+#define LISTS_PIPE_TAKE		2
+#define LISTS_PIPE_SKIP		3
+
+/* Int List pipeline structures */
+typedef struct {
+	int type;
+	IntListMapFunc *map_func;
+	IntListFilterFunc *filter_func;
+	unsigned long n;
+	void *custom;
+} IntListStageType;
+typedef IntListStageType *IntListStagePtr;
+
+typedef struct {
+	IntListPtr list;
+	int size;
+	IntListStageType stage[LISTS_PIPE_MAX];
+} IntListPipeType;
+typedef IntListPipeType *IntListPipePtr;
+
+/* Int List pipeline functions (stages run front to back in a single pass) */
+int IntListPipeInit(IntListPipePtr pipeline, IntListPtr list);
+int IntListPipeMap(IntListPipePtr pipeline, IntListMapFunc map_func, void *custom);
+int IntListPipeFilter(IntListPipePtr pipeline, IntListFilterFunc filter_func, void *custom);
+int IntListPipeTake(IntListPipePtr pipeline, unsigned long n);
+int IntListPipeSkip(IntListPipePtr pipeline, unsigned long n);
+int IntListPipeReduce(IntListPipePtr pipeline, IntListReduceFunc reduce_func, long *value, long initial, void *custom);
+long IntListPipeCount(IntListPipePtr pipeline);
+int IntListPipeCollect(IntListPipePtr pipeline, IntListPtr dest);
+long IntListPipeFind(IntListPipePtr pipeline, long *value);
+
+/* Packed Int List structures */
+#define INTLIST_PACK_BLOCK	128
+
+typedef struct {
+	long base;
+	long max;
+	unsigned long offset;
+	unsigned char bits;
+	unsigned char delta;
+} IntListBlockType;
+typedef IntListBlockType *IntListBlockPtr;
+
+typedef struct {
+	IntListBlockType *block;
+	unsigned char *data;
+	unsigned long size;
+	unsigned long blocks;
+	unsigned long bytes;
+} IntListPackType;
+typedef IntListPackType *IntListPackPtr;
+
+typedef struct {
+	IntListPackPtr pack;
+	unsigned long index;
+	unsigned long block;
+	long buffer[INTLIST_PACK_BLOCK];
+} IntListPackIterType;
+typedef IntListPackIterType *IntListPackIterPtr;
+
+/* Packed Int List functions */
+int IntListCompress(IntListPackPtr pack, IntListPtr list);
+int IntListDecompress(IntListPtr list, IntListPackPtr pack);
+void IntListPackFree(IntListPackPtr pack);
+long IntListPackSize(IntListPackPtr pack);
+unsigned long IntListPackBytes(IntListPackPtr pack);
+int IntListPackGet(IntListPackPtr pack, long index, long *value);
+long IntListPackFind(IntListPackPtr pack, long value);
+long IntListPackLowerBound(IntListPackPtr pack, long value);
+int IntListPackIterInit(IntListPackIterPtr iter, IntListPackPtr pack, long index);
+int IntListPackNext(IntListPackIterPtr iter, long *value);
+
+/* Segmented Int List structures (long elements in blocks of at most block_size) */
+#define INTSEG_BLOCK		4096
+
+typedef struct {
+	long *data;
+	long size;
+} IntSegBlockType;
+typedef IntSegBlockType *IntSegBlockPtr;
+
+typedef struct {
+	IntSegBlockType *block;
+	long *tree;		/* Fenwick tree over block sizes */
+	long blocks;
+	long reserve;
+	long size;
+	long block_size;
+} IntSegListType;
+typedef IntSegListType *IntSegListPtr;
+
+/* Segmented Int List callback functions */
+typedef long (IntSegListMapFunc)(IntSegListPtr list, long index, long value, void *custom);
+typedef long (IntSegListReduceFunc)(IntSegListPtr list, long x, long value, void *custom);
+
+/* Segmented Int List functions (edits move at most one block) */
+int IntSegListInit(IntSegListPtr list, long block_size);
+void IntSegListFree(IntSegListPtr list);
+long IntSegListSize(IntSegListPtr list);
+int IntSegListInsert(IntSegListPtr list, long index, long value);
+int IntSegListRemove(IntSegListPtr list, long index, unsigned long size);
+int IntSegListPush(IntSegListPtr list, long value);
+int IntSegListPop(IntSegListPtr list, long *value);
+int IntSegListSet(IntSegListPtr list, long index, long value);
+int IntSegListGet(IntSegListPtr list, long index, long *value);
+long IntSegListFind(IntSegListPtr list, long value);
+int IntSegListMap(IntSegListPtr list, IntSegListMapFunc map_func, void *custom);
+int IntSegListReduce(IntSegListPtr list, IntSegListReduceFunc reduce_func, long *value, long initial, void *custom);
+
+/* Int List window structures (a ring of the last capacity values, with min and max deques of sequence numbers) */
+typedef struct {
+	long *value;
+	unsigned long *min;
+	unsigned long *max;
+	unsigned long capacity;
+	unsigned long count;
+	unsigned long pushed;		/* sequence number of the next value */
+	unsigned long min_first;
+	unsigned long min_last;
+	unsigned long max_first;
+	unsigned long max_last;
+	long sum;
+} IntListWindowType;
+typedef IntListWindowType *IntListWindowPtr;
+
+/* Int List window functions (O(1) amortised per push or evict; pushing into a full window evicts the oldest) */
+int IntListWindowInit(IntListWindowPtr window, unsigned long capacity);
+void IntListWindowFree(IntListWindowPtr window);
+int IntListWindowPush(IntListWindowPtr window, long value);
+int IntListWindowEvict(IntListWindowPtr window, long *value);
+unsigned long IntListWindowCount(IntListWindowPtr window);
+long IntListWindowSum(IntListWindowPtr window);
+int IntListWindowMin(IntListWindowPtr window, long *value);
+int IntListWindowMax(IntListWindowPtr window, long *value);
+int IntListWindowGet(IntListWindowPtr window, long index, long *value);
+
+/* Bitmap structures (one container per 64K values: sorted array, 8K bitmap or runs) */
+#define BITMAP_ARRAY		0
+#define BITMAP_BITS			1
+#define BITMAP_RUN			2
+#define BITMAP_ARRAY_MAX	4096
+
+typedef struct {
+	long key;			/* value >> 16 */
+	int type;
+	unsigned long size;	/* values, or runs for a run container */
+	unsigned long reserve;
+	void *data;
+} BitmapContainerType;
+typedef BitmapContainerType *BitmapContainerPtr;
+
+typedef struct {
+	BitmapContainerType *container;
+	unsigned long size;
+	unsigned long reserve;
+} BitmapType;
+typedef BitmapType *BitmapPtr;
+
+/* Bitmap functions (dest must differ from the sources) */
+int BitmapInit(BitmapPtr bitmap);
+void BitmapFree(BitmapPtr bitmap);
+int BitmapAdd(BitmapPtr bitmap, long value);
+int BitmapContains(BitmapPtr bitmap, long value);
+unsigned long BitmapCardinality(BitmapPtr bitmap);
+unsigned long BitmapBytes(BitmapPtr bitmap);
+int BitmapUnion(BitmapPtr dest, BitmapPtr a, BitmapPtr b);
+int BitmapIntersect(BitmapPtr dest, BitmapPtr a, BitmapPtr b);
+int BitmapOptimize(BitmapPtr bitmap);	/* switches containers to runs where smaller */
+int IntListToBitmap(BitmapPtr bitmap, IntListPtr list);
+int BitmapToIntList(IntListPtr list, BitmapPtr bitmap);	/* ascending */
+
 
 /* Void List structures */
 struct VoidListStruct;
@@ -89,6 +381,10 @@ typedef int (VoidListAllocFunc)(VoidListPtr list, void **, void *, size_t);
 typedef void (VoidListFreeFunc)(VoidListPtr list, void *);
 typedef void (VoidListCpyFunc)(VoidListPtr list, void *, void *, size_t);
 typedef int (VoidListCmpFunc)(VoidListPtr list, void *, void *, size_t);
+typedef void (VoidListFreeBlockFunc)(VoidListPtr list, void **, long);
+
+/* Elements released per block free call */
+#define LISTS_FREE_BATCH	256
 
 /* Void List structures continued */
 struct VoidListStruct {
@@ -101,6 +397,9 @@ struct VoidListStruct {
 	VoidListFreeFunc *free_func;
 	VoidListCpyFunc *cpy_func;
 	VoidListCmpFunc *cmp_func;
+	VoidListFreeBlockFunc *free_block_func;	/* optional, set after init */
+	void *custom;
+	size_t budget;
 };
 
 /* Void List functions */
@@ -110,10 +409,17 @@ int VoidListInit(VoidListPtr list, long reserve, long grow, size_t width,
 void VoidListFree(VoidListPtr list);
 void VoidListDump(VoidListPtr list, FILE *stream, int type);
 int VoidListReserve(VoidListPtr list, unsigned long size, unsigned long grow, size_t width);
+int VoidListReserveAddress(VoidListPtr list, unsigned long size);
+int VoidListSetBudget(VoidListPtr list, size_t bytes);	/* pointer buffer only, not the elements */
+size_t VoidListBytes(VoidListPtr list);
+int VoidListTrim(VoidListPtr list);
+int VoidListRegister(VoidListPtr list);	/* for ListsTrimAll, until VoidListFree */
 long VoidListSize(VoidListPtr list);
 int VoidListRemove(VoidListPtr list, long index, long size);
 int VoidListResize(VoidListPtr list, unsigned long size, void *value, size_t width);
 void *VoidListPush(VoidListPtr list, void *value, size_t width);
+void *VoidListEmplace(VoidListPtr list, size_t width);	/* unset storage, for lists freeing with lists_free */
+void *VoidListPushNoCopy(VoidListPtr list, void *value);	/* the list takes ownership of value */
 void *VoidListPop(VoidListPtr list, void *value, size_t width);
 void **VoidListPointer(VoidListPtr list, long index);
 int VoidListSet(VoidListPtr list, long index, void *value, size_t width);
@@ -123,6 +429,21 @@ int VoidListReverse(VoidListPtr list, long index, unsigned long size);
 int VoidListRotate(VoidListPtr list, long amount, long index, unsigned long size);
 int VoidListCopy(VoidListPtr dest, VoidListPtr src, long index, unsigned long size);
 int VoidListMove(VoidListPtr dest, VoidListPtr src, long index, unsigned long size);
+int VoidListRemoveIndices(VoidListPtr list, IntListPtr indices);
+int VoidListSwapRemove(VoidListPtr list, long index);
+
+/* Void List sorting functions (stable through cmp_func; duplicates go through free_func) */
+int VoidListSort(VoidListPtr list);
+int VoidListSortParallel(VoidListPtr list, int threads);
+int VoidListUniqueParallel(VoidListPtr list, int threads);
+
+/* Void List heap functions (ordered by cmp_func) */
+int VoidListHeapify(VoidListPtr list, int flags);
+void *VoidListHeapPush(VoidListPtr list, void *value, size_t width, int flags);
+void *VoidListHeapPop(VoidListPtr list, void *value, size_t width, int flags);
+int VoidListHeapReplace(VoidListPtr list, void *value, size_t width, void *top, int flags);
+void *VoidListHeapPeek(VoidListPtr list);
+int VoidListPartialSort(VoidListPtr list, unsigned long k, int flags);	/* same, ordered by cmp_func */
 
 /* Void List mapping callback functions */
 typedef void *(VoidListMapFunc)(VoidListPtr list, long index, void *value, void *custom);
@@ -133,15 +454,55 @@ typedef void *(VoidListReduceFunc)(VoidListPtr list, void *x, void *value, void
 int VoidListMap(VoidListPtr list, VoidListMapFunc map_func, void *custom);
 int VoidListFilter(VoidListPtr list, VoidListFilterFunc filter_func, void *custom);
 int VoidListReduce(VoidListPtr list, VoidListReduceFunc reduce_func, void **value, void *initial, void *custom);
+int VoidListRemoveIf(VoidListPtr list, VoidListFilterFunc remove_func, void *custom);
+
+/* Void List block callback functions */
+typedef void (VoidListMapBlockFunc)(VoidListPtr list, long index, void **values, unsigned long count, void *custom);
+typedef unsigned long (VoidListFilterBlockFunc)(VoidListPtr list, void **values, unsigned char *keep, unsigned long count, void *custom);
+typedef void *(VoidListReduceBlockFunc)(VoidListPtr list, void *x, void **values, unsigned long count, void *custom);
+
+/* Void List block mapping functions */
+int VoidListMapBlock(VoidListPtr list, VoidListMapBlockFunc map_func, unsigned long block, void *custom);
+int VoidListFilterBlock(VoidListPtr list, VoidListFilterBlockFunc filter_func, unsigned long block, void *custom);
+int VoidListReduceBlock(VoidListPtr list, VoidListReduceBlockFunc reduce_func, unsigned long block, void **value, void *initial, void *custom);
 
 void VoidListPrint(VoidListPtr list, FILE *stream, VoidListMapFunc func);
 
+/* Void List pipeline structures */
+typedef struct {
+	int type;
+	VoidListMapFunc *map_func;
+	VoidListFilterFunc *filter_func;
+	unsigned long n;
+	void *custom;
+} VoidListStageType;
+typedef VoidListStageType *VoidListStagePtr;
+
+typedef struct {
+	VoidListPtr list;
+	int size;
+	VoidListStageType stage[LISTS_PIPE_MAX];
+} VoidListPipeType;
+typedef VoidListPipeType *VoidListPipePtr;
+
+/* Void List pipeline functions (stages run front to back in a single pass) */
+int VoidListPipeInit(VoidListPipePtr pipeline, VoidListPtr list);
+int VoidListPipeMap(VoidListPipePtr pipeline, VoidListMapFunc map_func, void *custom);
+int VoidListPipeFilter(VoidListPipePtr pipeline, VoidListFilterFunc filter_func, void *custom);
+int VoidListPipeTake(VoidListPipePtr pipeline, unsigned long n);
+int VoidListPipeSkip(VoidListPipePtr pipeline, unsigned long n);
+int VoidListPipeReduce(VoidListPipePtr pipeline, VoidListReduceFunc reduce_func, void **value, void *initial, void *custom);
+long VoidListPipeCount(VoidListPipePtr pipeline);
+int VoidListPipeCollect(VoidListPipePtr pipeline, VoidListPtr dest);
+long VoidListPipeFind(VoidListPipePtr pipeline, void **value);
+
 /* Void List callback functions */
 int voidlist_alloc(VoidListPtr list, void **ptr, void *value, size_t size);
 void voidlist_free(VoidListPtr list, void *ptr);
 void voidlist_cpy(VoidListPtr list, void *dest, void *src, size_t size);
 int voidlist_cmp(VoidListPtr list, void *ptr1, void *ptr2, size_t size);
 void *voidlist_print(VoidListPtr list, long index, void *value, void *custom);
+long voidlist_free_block(VoidListPtr list, void **ptr, long size);
 
 /* String List types */
 typedef VoidListType StrListType;
@@ -152,20 +513,48 @@ int StrListInit(StrListPtr list, long reserve, long grow);
 #define StrListFree		VoidListFree
 void StrListDump(StrListPtr list, FILE *stream, int type);
 int StrListReserve(VoidListPtr list, unsigned long size, unsigned long grow);
+#define StrListReserveAddress	VoidListReserveAddress
+#define StrListSetBudget	VoidListSetBudget
+#define StrListBytes	VoidListBytes
+#define StrListTrim		VoidListTrim
+#define StrListRegister	VoidListRegister
 #define StrListSize		VoidListSize
 #define StrListRemove	VoidListRemove
 int StrListResize(StrListPtr list, unsigned long size, char *value);
 char *StrListPush(StrListPtr list, char *value);
+#define StrListEmplace(list, length)	((char *)VoidListEmplace(list, (length) + 1))	/* StrListInit lists only */
+#define StrListPushNoCopy	VoidListPushNoCopy
 char *StrListPop(StrListPtr list, char *value);
 #define StrListPointer	VoidListPointer
 int StrListSet(StrListPtr list, long index, char *value);
 int StrListGet(StrListPtr list, long index, char *value);
+int StrListGetN(StrListPtr list, long index, char *value, size_t size);
 long StrListFind(StrListPtr list, char *value);
 long StrListFindCase(StrListPtr list, char *value);
+int StrListFindPrefix(StrListPtr list, char *prefix, long *first, long *count);
+unsigned long StrListEstimate(StrListPtr list);
+int StrListUnique(StrListPtr list, unsigned long expect);
+int StrListCount(StrListPtr list, StrListPtr values, IntListPtr counts, unsigned long expect);
 #define StrListReverse	VoidListReverse
 #define StrListRotate	VoidListRotate
 #define StrListCopy		VoidListCopy
 #define StrListMove		VoidListMove
+#define StrListRemoveIndices	VoidListRemoveIndices
+#define StrListSwapRemove	VoidListSwapRemove
+#define StrListSort		VoidListSort
+#define StrListSortParallel	VoidListSortParallel
+#define StrListUniqueParallel	VoidListUniqueParallel
+#define StrListHeapify		VoidListHeapify
+#define StrListHeapPeek		VoidListHeapPeek
+#define StrListPartialSort	VoidListPartialSort
+char *StrListHeapPush(StrListPtr list, char *value, int flags);
+char *StrListHeapPop(StrListPtr list, char *value, int flags);
+
+/* String List external sort (produced strings stay valid until the next call; NULL callbacks mean in/out are FILEs of lines) */
+typedef char *(StrListProduceFunc)(void *custom);
+typedef int (StrListConsumeFunc)(char *value, void *custom);
+int StrListExternalSort(StrListProduceFunc produce_func, void *in, StrListConsumeFunc consume_func, void *out,
+		size_t memory, int flags);
 
 /* String List mapping callback functions */
 typedef char *(StrListMapFunc)(StrListPtr list, long index, char *value, void *custom);
@@ -176,8 +565,36 @@ typedef void *(StrListReduceFunc)(StrListPtr list, void *x, char *value, void *c
 int StrListMap(StrListPtr list, StrListMapFunc map_func, void *custom);
 int StrListFilter(StrListPtr list, StrListFilterFunc filter_func, void *custom);
 int StrListReduce(StrListPtr list, StrListReduceFunc reduce_func, void **value, void *initial, void *custom);
+int StrListRemoveIf(StrListPtr list, StrListFilterFunc remove_func, void *custom);
+
+/* String List block callback functions */
+typedef void (StrListMapBlockFunc)(StrListPtr list, long index, char **values, unsigned long count, void *custom);
+typedef unsigned long (StrListFilterBlockFunc)(StrListPtr list, char **values, unsigned char *keep, unsigned long count, void *custom);
+typedef void *(StrListReduceBlockFunc)(StrListPtr list, void *x, char **values, unsigned long count, void *custom);
+
+/* String block mapping functions */
+int StrListMapBlock(StrListPtr list, StrListMapBlockFunc map_func, unsigned long block, void *custom);
+int StrListFilterBlock(StrListPtr list, StrListFilterBlockFunc filter_func, unsigned long block, void *custom);
+int StrListReduceBlock(StrListPtr list, StrListReduceBlockFunc reduce_func, unsigned long block, void **value, void *initial, void *custom);
 
 void StrListPrint(StrListPtr list, FILE *stream, VoidListMapFunc func);
+int StrListWrite(StrListPtr list, FILE *stream, char delimiter);
+int StrListWriteFd(StrListPtr list, int fd, char delimiter);
+
+/* String List pipeline types */
+typedef VoidListPipeType StrListPipeType;
+typedef StrListPipeType *StrListPipePtr;
+
+/* String List pipeline functions */
+#define StrListPipeInit		VoidListPipeInit
+int StrListPipeMap(StrListPipePtr pipeline, StrListMapFunc map_func, void *custom);
+int StrListPipeFilter(StrListPipePtr pipeline, StrListFilterFunc filter_func, void *custom);
+#define StrListPipeTake		VoidListPipeTake
+#define StrListPipeSkip		VoidListPipeSkip
+int StrListPipeReduce(StrListPipePtr pipeline, StrListReduceFunc reduce_func, void **value, void *initial, void *custom);
+#define StrListPipeCount	VoidListPipeCount
+#define StrListPipeCollect	VoidListPipeCollect
+long StrListPipeFind(StrListPipePtr pipeline, char **value);
 
 /* String List callback functions */
 int strlist_alloc(StrListPtr list, void **ptr, void *value, size_t size);
@@ -186,4 +603,138 @@ int strlist_cmp(StrListPtr list, void *ptr1, void *ptr2, size_t size);
 int strlist_icmp(StrListPtr list, void *ptr1, void *ptr2, size_t size);
 void *strlist_print(StrListPtr list, long index, void *value, void *custom);
 
+/* String intern structures */
+typedef struct {
+	char *value;
+	unsigned long hash;
+	unsigned long refs;
+} StrInternEntryType;
+
+typedef struct {
+	StrInternEntryType *table;
+	unsigned long size;
+	unsigned long count;
+} StrInternType;
+typedef StrInternType *StrInternPtr;
+
+/* String intern functions (free every list using a table before the table itself) */
+int StrInternInit(StrInternPtr intern, unsigned long reserve);
+void StrInternFree(StrInternPtr intern);
+long StrInternSize(StrInternPtr intern);
+char *StrInternAcquire(StrInternPtr intern, char *value);
+char *StrInternLookup(StrInternPtr intern, char *value);
+void StrInternRelease(StrInternPtr intern, char *value);
+
+/* Interned String List functions */
+int StrListInitIntern(StrListPtr list, long reserve, long grow, StrInternPtr intern);
+int strlist_intern_alloc(StrListPtr list, void **ptr, void *value, size_t size);
+void strlist_intern_free(StrListPtr list, void *ptr);
+
+/* Hashed String List structures (header sits in front of each entry's characters) */
+typedef struct {
+	size_t length;
+	unsigned long hash;
+} StrListHeadType;
+typedef StrListHeadType *StrListHeadPtr;
+
+/* Hashed String List functions */
+int StrListInitHashed(StrListPtr list, long reserve, long grow);
+int strlist_hash_alloc(StrListPtr list, void **ptr, void *value, size_t size);
+void strlist_hash_free(StrListPtr list, void *ptr);
+void strlist_hash_cpy(StrListPtr list, void *dest, void *src, size_t size);
+
+/* String List index structures (radix trie over a sorted permutation of the list) */
+typedef struct {
+	unsigned int lo;
+	unsigned int hi;
+	unsigned int child;
+	unsigned int children;
+	unsigned int term;
+	unsigned int depth;
+} StrListNodeType;
+typedef StrListNodeType *StrListNodePtr;
+
+typedef struct {
+	StrListPtr list;
+	IntListType order;
+	StrListNodeType *node;
+	unsigned long nodes;
+	unsigned long reserve;
+} StrListIndexType;
+typedef StrListIndexType *StrListIndexPtr;
+
+/* String List index functions (rebuild after the list changes) */
+int StrListIndexBuild(StrListIndexPtr index, StrListPtr list);
+void StrListIndexFree(StrListIndexPtr index);
+long StrListIndexFind(StrListIndexPtr index, char *value);
+int StrListIndexPrefix(StrListIndexPtr index, char *prefix, long *first, long *count);
+long StrListIndexGet(StrListIndexPtr index, long position);
+
+/* Front coded String List structures (read-only; each bucket holds a full head, then shared-prefix lengths and suffixes) */
+#define STRFRONT_BUCKET		16
+
+typedef struct {
+	char *data;
+	unsigned long *bucket;		/* data offset of each bucket head */
+	unsigned long buckets;
+	unsigned long size;
+	size_t bytes;
+	size_t longest;
+} StrFrontType;
+typedef StrFrontType *StrFrontPtr;
+
+typedef int (StrFrontIterateFunc)(StrFrontPtr front, long index, char *value, void *custom);
+
+/* Front coded String List functions (value is only valid during an iterate callback) */
+int StrListFrontCode(StrFrontPtr front, StrListPtr list);	/* list must be sorted */
+void StrFrontFree(StrFrontPtr front);
+long StrFrontSize(StrFrontPtr front);
+size_t StrFrontBytes(StrFrontPtr front);
+int StrFrontGet(StrFrontPtr front, long index, char *value, size_t size);
+long StrFrontFind(StrFrontPtr front, char *value);
+int StrFrontPrefix(StrFrontPtr front, char *prefix, long *first, long *count);
+int StrFrontIterate(StrFrontPtr front, char *prefix, StrFrontIterateFunc func, void *custom);
+
+/* String map structures (Robin Hood open addressing, keys copied into one arena) */
+typedef struct {
+	unsigned long hash;
+	unsigned long key;			/* arena offset */
+	unsigned int length;
+	unsigned int distance;		/* probe distance + 1, 0 when free */
+	long value;
+	void *payload;
+} StrMapEntryType;
+typedef StrMapEntryType *StrMapEntryPtr;
+
+typedef struct {
+	StrMapEntryType *entry;
+	unsigned long size;
+	unsigned long count;
+	char *arena;
+	unsigned long arena_size;
+	unsigned long arena_used;
+	unsigned long arena_dead;
+	VoidListType payload;		/* payload width and callbacks; no alloc_func for long values */
+} StrMapType;
+typedef StrMapType *StrMapPtr;
+
+/* String map callback functions (return FALSE to stop iterating) */
+typedef int (StrMapIterFunc)(StrMapPtr map, char *key, long value, void *payload, void *custom);
+
+/* String map functions (key pointers stay valid until the next Put or Delete) */
+int StrMapInit(StrMapPtr map, unsigned long reserve);
+int StrMapInitPayload(StrMapPtr map, unsigned long reserve, size_t width,
+		VoidListAllocFunc alloc_func, VoidListFreeFunc free_func, VoidListCpyFunc cpy_func);
+void StrMapFree(StrMapPtr map);
+long StrMapSize(StrMapPtr map);
+int StrMapPut(StrMapPtr map, char *key, long value);
+int StrMapGet(StrMapPtr map, char *key, long *value);
+int StrMapPutValue(StrMapPtr map, char *key, void *value);
+int StrMapGetValue(StrMapPtr map, char *key, void *value);
+void *StrMapPointer(StrMapPtr map, char *key);
+int StrMapDelete(StrMapPtr map, char *key);
+int StrMapIterate(StrMapPtr map, StrMapIterFunc iter_func, void *custom);
+int StrMapKeys(StrMapPtr map, StrListPtr keys);
+int StrMapValues(StrMapPtr map, IntListPtr values);	/* long valued maps only, same order as the keys */
+
 #endif /* __LISTS_H__ */
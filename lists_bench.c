@@ -0,0 +1,239 @@
+// gcc -O2 lists.c lists_bench.c -o lists_bench
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "lists.h"
+
+#define EDITS			100
+
+unsigned long bench_seed = 88172645463325252UL;
+
+unsigned long bench_rand(void)
+{
+	bench_seed ^= bench_seed << 13;
+	bench_seed ^= bench_seed >> 7;
+	bench_seed ^= bench_seed << 17;
+
+	return(bench_seed);
+}
+
+double bench_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return(ts.tv_sec + ts.tv_nsec / 1e9);
+}
+
+/* Random-position insert then remove, edits of each; returns ns per edit */
+double bench_flat(long size, long edits)
+{
+	IntListType list;
+	double t;
+	long i;
+
+	IntListInit(&list, size + edits, 1024);
+	for(i=0; i < size; i++)
+		IntListPush(&list, i);
+
+	t = bench_now();
+	for(i=0; i < edits; i++) {
+		IntListPush(&list, i);
+		IntListRotate(&list, 1, bench_rand() % IntListSize(&list), 0);
+	}
+	for(i=0; i < edits; i++)
+		IntListRemove(&list, bench_rand() % IntListSize(&list), 1);
+	t = bench_now() - t;
+
+	IntListFree(&list);
+
+	return(t * 1e9 / (edits * 2));
+}
+
+double bench_seg(long size, long edits)
+{
+	IntSegListType list;
+	double t;
+	long i;
+
+	IntSegListInit(&list, 0);
+	for(i=0; i < size; i++)
+		IntSegListPush(&list, i);
+
+	t = bench_now();
+	for(i=0; i < edits; i++)
+		IntSegListInsert(&list, bench_rand() % (IntSegListSize(&list) + 1), i);
+	for(i=0; i < edits; i++)
+		IntSegListRemove(&list, bench_rand() % IntSegListSize(&list), 1);
+	t = bench_now() - t;
+
+	IntSegListFree(&list);
+
+	return(t * 1e9 / (edits * 2));
+}
+
+/* Membership tests on a dense set: ns per lookup and bytes for IntList and Bitmap */
+void bench_bitmap(long size, long lookups)
+{
+	IntListType list;
+	BitmapType bitmap;
+	double t[2];
+	long i, found = 0;
+
+	IntListInit(&list, size, 1024);
+	for(i=0; i < size; i++)
+		IntListPush(&list, i * 2);
+	BitmapInit(&bitmap);
+	IntListToBitmap(&bitmap, &list);
+	BitmapOptimize(&bitmap);
+
+	t[0] = bench_now();
+	for(i=0; i < lookups; i++)
+		found += IntListFind(&list, bench_rand() % (size * 2)) >= 0;
+	t[0] = bench_now() - t[0];
+
+	t[1] = bench_now();
+	for(i=0; i < lookups * 1000; i++)
+		found += BitmapContains(&bitmap, bench_rand() % (size * 2));
+	t[1] = bench_now() - t[1];
+
+	printf("%12ld %14.1f %14.1f %14lu %14lu\n", size, t[0] * 1e9 / lookups, t[1] * 1e9 / (lookups * 1000),
+			IntListSize(&list) * sizeof(long), BitmapBytes(&bitmap));
+
+	IntListFree(&list);
+	BitmapFree(&bitmap);
+}
+
+void *bench_sum(VoidListPtr list, void *x, void *value, void *custom)
+{
+	return((char *)x + *(long *)value);
+}
+
+/* Full scans over scattered 64-byte records, ns per element for each prefetch distance */
+void bench_void(long size)
+{
+	VoidListType list;
+	char record[64] = { 0 };
+	unsigned long distance[] = { 0, 4, LISTS_PREFETCH, 16, 32 }, d;
+	void *sum, *tmp;
+	double t[2];
+	long i, j;
+
+	VoidListInit(&list, size, 1024, sizeof(record), NULL, NULL, NULL, NULL);
+	for(i=0; i < size; i++) {
+		*(long *)record = i;
+		VoidListPush(&list, record, 0);
+	}
+	/* Shuffle the pointers so consecutive elements live far apart */
+	for(i=size - 1; i > 0; i--) {
+		j = bench_rand() % (i + 1);
+		tmp = list.start[i];
+		list.start[i] = list.start[j];
+		list.start[j] = tmp;
+	}
+	*(long *)record = -1;
+
+	for(d=0; d < sizeof(distance) / sizeof(*distance); d++) {
+		ListsSetPrefetch(distance[d]);
+
+		t[0] = bench_now();
+		VoidListReduce(&list, bench_sum, &sum, NULL, NULL);
+		t[0] = bench_now() - t[0];
+
+		t[1] = bench_now();
+		VoidListFind(&list, record, 0);
+		t[1] = bench_now() - t[1];
+
+		printf("%12ld %10lu %14.2f %14.2f\n", size, distance[d], t[0] * 1e9 / size, t[1] * 1e9 / size);
+	}
+
+	ListsSetPrefetch(LISTS_PREFETCH);
+	VoidListFree(&list);
+}
+
+int bench_keep(IntListPtr list, long value, void *custom)
+{
+	return(value >= 0);
+}
+
+long bench_double(IntListPtr list, long index, long value, void *custom)
+{
+	return(value * 2);
+}
+
+long bench_add(IntListPtr list, long x, long value, void *custom)
+{
+	return(x + value);
+}
+
+/* Copy, filter, map and reduce as separate passes against one pipeline: ns per element and bytes streamed */
+void bench_pipe(long size)
+{
+	IntListType list, copy;
+	IntListPipeType pipeline;
+	double t[2];
+	long i, sum[2];
+	unsigned long bytes;
+
+	IntListInit(&list, size, 1024);
+	for(i=0; i < size; i++)
+		IntListPush(&list, i);
+	bytes = size * list.width;
+
+	/* Copy reads and writes, filter reads (every value passes), map reads and writes, reduce reads */
+	t[0] = bench_now();
+	IntListInit(&copy, 0, 1024);
+	IntListCopy(&copy, &list, 0, 0);
+	IntListFilter(&copy, bench_keep, NULL);
+	IntListMap(&copy, bench_double, NULL);
+	IntListReduce(&copy, bench_add, sum, 0, NULL);
+	t[0] = bench_now() - t[0];
+	IntListFree(&copy);
+
+	/* The pipeline reads the source once */
+	t[1] = bench_now();
+	IntListPipeInit(&pipeline, &list);
+	IntListPipeFilter(&pipeline, bench_keep, NULL);
+	IntListPipeMap(&pipeline, bench_double, NULL);
+	IntListPipeReduce(&pipeline, bench_add, sum + 1, 0, NULL);
+	t[1] = bench_now() - t[1];
+
+	printf("%12ld %14.2f %14.2f %14lu %14lu%s\n", size, t[0] * 1e9 / size, t[1] * 1e9 / size,
+			bytes * 6, bytes, sum[0] == sum[1] ? "" : " (sums differ)");
+
+	IntListFree(&list);
+}
+
+int main(int argc, char **argv)
+{
+	long size, max = argc > 1 ? atol(argv[1]) : 100000000, edits = argc > 2 ? atol(argv[2]) : EDITS;
+
+	printf("Random-position edits (%ld inserts + %ld removes), ns per edit\n", edits, edits);
+	printf("%12s %14s %14s\n", "elements", "IntList", "IntSegList");
+
+	for(size = 1000000; size <= max; size *= 10)
+		printf("%12ld %14.1f %14.1f\n", size, bench_flat(size, edits), bench_seg(size, edits));
+
+	printf("\nMembership tests on even numbers, ns per lookup and bytes\n");
+	printf("%12s %14s %14s %14s %14s\n", "elements", "IntListFind", "BitmapContains", "IntList", "Bitmap");
+
+	for(size = 1000000; size <= max; size *= 10)
+		bench_bitmap(size, edits);
+
+	printf("\nScans of scattered 64-byte records, ns per element\n");
+	printf("%12s %10s %14s %14s\n", "elements", "prefetch", "VoidListReduce", "VoidListFind");
+
+	for(size = 1000000; size <= max && size <= 10000000; size *= 10)
+		bench_void(size);
+
+	printf("\nCopy, filter, map, reduce: separate passes against one pipeline, ns per element and bytes streamed\n");
+	printf("%12s %14s %14s %14s %14s\n", "elements", "passes", "pipeline", "passes", "pipeline");
+
+	for(size = 1000000; size <= max; size *= 10)
+		bench_pipe(size);
+
+	return(0);
+}
@@ -8,6 +8,7 @@
 #include "lists.h"
 
 #define TMPLEN			65536
+#define STRLEN			256
 #define WORDLIST		"/usr/share/dict/words"
 
 void int_getset(IntListPtr list, long index, long value, long assert)
@@ -29,7 +30,7 @@ void int_getset(IntListPtr list, long index, long value, long assert)
 
 void void_getset(VoidListPtr list, long index, char *value, char *assert)
 {
-	char s[TMPLEN];
+	char s[STRLEN];
 
 	printf("Get Item %ld/%lu: ", index, VoidListSize(list));
 	if(VoidListGet(list, index, s, strlen(assert) + 1))
@@ -62,6 +63,143 @@ void str_getset(StrListPtr list, long index, char *value, char *assert)
 		printf("Item %ld: %s (should now be %s)\n", index, s, value);
 }
 
+int int_even(IntListPtr list, long value, void *custom)
+{
+	return(!(value & 1));
+}
+
+long int_triple(IntListPtr list, long index, long value, void *custom)
+{
+	return(value * 3);
+}
+
+long int_sum(IntListPtr list, long x, long value, void *custom)
+{
+	return(x + value);
+}
+
+long int_sum_block(IntListPtr list, long x, long *values, unsigned long count, void *custom)
+{
+	while(count--)
+		x += *values++;
+
+	return(x);
+}
+
+/* Keeps values whose hundreds digit isn't 1, 4 or 7 */
+unsigned long int_keep_block(IntListPtr list, long *values, unsigned char *keep, unsigned long count, void *custom)
+{
+	unsigned long n, kept = 0;
+
+	for(n = 0; n < count; n++)
+		kept += keep[n] = values[n] % 3 != 1;
+
+	return(kept);
+}
+
+unsigned long str_keep_block(StrListPtr list, char **values, unsigned char *keep, unsigned long count, void *custom)
+{
+	unsigned long n, kept = 0;
+
+	for(n = 0; n < count; n++)
+		kept += keep[n] = atol(values[n] + 1) / 100 % 3 != 1;
+
+	return(kept);
+}
+
+long test_allocs = 0;
+
+void *test_malloc(size_t size)
+{
+	test_allocs++;
+	return(malloc(size));
+}
+
+void *test_realloc(void *ptr, size_t size)
+{
+	test_allocs += !ptr;
+	return(realloc(ptr, size));
+}
+
+void test_free(void *ptr)
+{
+	test_allocs -= ptr != NULL;
+	free(ptr);
+}
+
+int int_produce(long *value, void *custom)
+{
+	long *state = custom;
+
+	if(!state[0])
+		return(FALSE);
+
+	*value = --state[0] % state[1];
+
+	return(TRUE);
+}
+
+int int_consume(long value, void *custom)
+{
+	long *state = custom;
+
+	/* Counts values, or stops on one out of order */
+	if(state[0] && value <= state[1])
+		return(FALSE);
+
+	state[0]++;
+	state[1] = value;
+
+	return(TRUE);
+}
+
+int void_long_cmp(VoidListPtr list, void *ptr1, void *ptr2, size_t width)
+{
+	return((*(long *)ptr1 > *(long *)ptr2) - (*(long *)ptr1 < *(long *)ptr2));
+}
+
+char str_last[TMPLEN * 2];
+
+int str_consume(char *value, void *custom)
+{
+	long *state = custom;
+
+	/* Counts strings and keeps the longest length, or stops on one out of order */
+	if(state[0] && strcmp(value, str_last) <= 0)
+		return(FALSE);
+
+	strcpy(str_last, value);
+	state[0]++;
+	if((long)strlen(value) > state[1])
+		state[1] = strlen(value);
+
+	return(TRUE);
+}
+
+int str_odd(StrListPtr list, char *value, void *custom)
+{
+	return((value[strlen(value) - 1] - '0') & 1);
+}
+
+int str_initial(StrListPtr list, char *value, void *custom)
+{
+	return(*value == *(char *)custom);
+}
+
+/* An allocator that is always out of memory */
+int str_refuse(VoidListPtr list, void **ptr, void *value, size_t width)
+{
+	return(FALSE);
+}
+
+/* Payload allocator that can be told to run out of memory */
+int map_refuse = FALSE;
+
+int map_alloc(VoidListPtr list, void **ptr, void *value, size_t size)
+{
+	return(!map_refuse && voidlist_alloc(list, ptr, value, size));
+}
+
 int main()
 {
 	long i, reserve = 1024, grow = 1024, push = grow * 16;
@@ -94,6 +232,80 @@ int main()
 	else
 		printf("not found.\n");
 
+	printf("Pipeline (filter even, map x3, skip 2, take 10): ");
+	IntListPipeType int_pipe;
+	IntListType int_dest;
+	IntListInit(&int_dest, 0, grow);
+	IntListPipeInit(&int_pipe, &int_list);
+	IntListPipeFilter(&int_pipe, int_even, NULL);
+	IntListPipeMap(&int_pipe, int_triple, NULL);
+	IntListPipeSkip(&int_pipe, 2);
+	IntListPipeTake(&int_pipe, 10);
+	IntListPipeCollect(&int_pipe, &int_dest);
+	IntListPrint(&int_dest, stdout, NULL);
+	IntListPipeReduce(&int_pipe, int_sum, &r, 0, NULL);
+	printf("Pipeline count: %ld, sum: %ld (should be 10, 390)\n", IntListPipeCount(&int_pipe), r);
+	IntListFree(&int_dest);
+
+	IntListReduce(&int_list, int_sum, &i, 0, NULL);
+	IntListReduceBlock(&int_list, int_sum_block, 0, &r, 0, NULL);
+	printf("Block reduce sum: %ld (should be %ld)\n", r, i);
+
+	IntListType int_block;
+	long prev, next;
+	IntListInitWidth(&int_block, 0, grow, 1);
+	for(i=0; i < 1000; i++)
+		IntListPush(&int_block, i / 100);
+	IntListFilterBlock(&int_block, int_keep_block, 64, NULL);
+	IntListReduce(&int_block, int_sum, &r, 0, NULL);
+	for(n=1, i=1; i < IntListSize(&int_block); i++) {
+		IntListGet(&int_block, i - 1, &prev);
+		IntListGet(&int_block, i, &next);
+		n &= prev <= next;
+	}
+	printf("Block filter on a byte-wide list in blocks of 64: %ld kept, sum %ld, %s (should be 700, 3300, in order)\n",
+			IntListSize(&int_block), r, n ? "in order" : "out of order");
+	IntListFree(&int_block);
+
+	IntListPackType int_pack;
+	printf("Compressing %lu elements: ", IntListSize(&int_list));
+	if(IntListCompress(&int_pack, &int_list))
+		printf("%lu bytes (raw %lu bytes)\n", IntListPackBytes(&int_pack),
+				IntListSize(&int_list) * sizeof(long));
+	else
+		printf("Error.\n");
+	printf("Packed search for '%ld': item %ld, lower bound %ld (should be %ld)\n", push >> 1,
+			IntListPackFind(&int_pack, push >> 1), IntListPackLowerBound(&int_pack, push >> 1), push >> 1);
+	IntListInit(&int_dest, 0, grow);
+	IntListDecompress(&int_dest, &int_pack);
+	printf("Decompressed %lu elements: %s\n", IntListSize(&int_dest),
+			memcmp(int_dest.start, int_list.start, IntListSize(&int_list) * sizeof(long)) ? "mismatch" : "match");
+	IntListFree(&int_dest);
+	IntListPackFree(&int_pack);
+
+	IntListPackIterType int_iter;
+	long got, last;
+	IntListInit(&int_dest, 0, grow);
+	for(i=0; i < 300; i++)
+		IntListPush(&int_dest, i * 3 - 500);
+	IntListCompress(&int_pack, &int_dest);
+	IntListPackGet(&int_pack, 127, &prev);
+	IntListPackGet(&int_pack, 128, &next);
+	IntListPackGet(&int_pack, -1, &last);
+	printf("Packed get of items 127, 128 and -1: %ld, %ld, %ld, item 300 %s (should be -119, -116, 397, rejected)\n",
+			prev, next, last, IntListPackGet(&int_pack, 300, NULL) ? "accepted" : "rejected");
+	IntListPackIterInit(&int_iter, &int_pack, 100);
+	for(n=0, r=1; IntListPackNext(&int_iter, &got); n++)
+		r &= got == (100 + n) * 3 - 500;
+	printf("Packed iteration from item 100: %ld values, %s, last %ld (should be 200, match, 397)\n",
+			n, r ? "match" : "mismatch", got);
+	r = IntListPackIterInit(&int_iter, &int_pack, 300);
+	printf("Packed iteration from the end: %s, next %s, from 301 %s (should be accepted, none, rejected)\n",
+			r ? "accepted" : "rejected", IntListPackNext(&int_iter, NULL) ? "value" : "none",
+			IntListPackIterInit(&int_iter, &int_pack, 301) ? "accepted" : "rejected");
+	IntListFree(&int_dest);
+	IntListPackFree(&int_pack);
+
 	printf("Pushing another %lu elements.\n", push);
 	for(i=0; i < push; i++) {
 		IntListPush(&int_list, i);
@@ -133,9 +345,349 @@ int main()
 		printf("Error.\n");
 	IntListDump(&int_list, stdout, 0);
 
+	IntListInit(&int_dest, 0, grow);
+	for(i=0; i < IntListSize(&int_list); i += 4)
+		IntListPush(&int_dest, i);
+	printf("Removing %lu scattered element(s): ", IntListSize(&int_dest));
+	if(IntListRemoveIndices(&int_list, &int_dest))
+		printf("Okay\n");
+	else
+		printf("Error.\n");
+	IntListDump(&int_list, stdout, 0);
+	IntListFree(&int_dest);
+
+	printf("Swap removing first element: ");
+	IntListGet(&int_list, -1, &r);
+	if(IntListSwapRemove(&int_list, 0) && IntListGet(&int_list, 0, &i))
+		printf("%ld (should be %ld)\n", i, r);
+	else
+		printf("Error.\n");
+
 	printf("Freeing list.\n");
 	IntListFree(&int_list);
 
+	printf("Removing indices 7, 2, 7, -1 from 0-9: ");
+	IntListInit(&int_list, 0, grow);
+	IntListInit(&int_dest, 0, grow);
+	for(i=0; i < 10; i++)
+		IntListPush(&int_list, i);
+	IntListPush(&int_dest, 7);
+	IntListPush(&int_dest, 2);
+	IntListPush(&int_dest, 7);
+	IntListPush(&int_dest, -1);
+	IntListRemoveIndices(&int_list, &int_dest);
+	IntListWrite(&int_list, stdout, ' ');
+	printf("(should be 0 1 3 4 5 6 8)\n");
+	IntListSet(&int_dest, 0, 10);
+	n = IntListRemoveIndices(&int_list, &int_dest);
+	printf("Removing index 10: %s, %ld left (should be rejected, 7)\n", n ? "done" : "rejected", IntListSize(&int_list));
+	printf("Removing even values: ");
+	IntListRemoveIf(&int_list, int_even, NULL);
+	IntListWrite(&int_list, stdout, ' ');
+	printf("(should be 1 3 5)\n");
+	IntListFree(&int_dest);
+	IntListFree(&int_list);
+
+	printf("Pushing %lu elements into a 1-byte lane list.\n", push);
+	IntListInitWidth(&int_list, reserve, grow, 1);
+	for(i=0; i < push; i++)
+		IntListPush(&int_list, i % 100);
+	IntListDump(&int_list, stdout, 0);
+	printf("Searching for '%d': item %ld\n", 99, IntListFind(&int_list, 99));
+	printf("Pushing %ld (widens lanes).\n", neg_max);
+	IntListPush(&int_list, neg_max);
+	IntListDump(&int_list, stdout, 0);
+	IntListGet(&int_list, -1, &r);
+	printf("Last item: %ld (should be %ld)\n", r, neg_max);
+	n = IntListWiden(&int_list, 3);
+	printf("Widening to 3 bytes: %s, to 2 bytes: %s (should be rejected, done)\n", n ? "done" : "rejected",
+			IntListWiden(&int_list, 2) ? "done" : "rejected");
+	IntListFree(&int_list);
+
+	printf("Pushing %lu elements into a 64-byte aligned, huge page backed list.\n", push);
+	ListsSetAlign(64);
+	ListsSetHugePage(push * sizeof(long) / 2);
+	IntListInit(&int_list, reserve, grow);
+	for(i=0; i < push; i++)
+		IntListPush(&int_list, i);
+	IntListDump(&int_list, stdout, 0);
+	printf("Buffer alignment: %s\n", (uintptr_t)int_list.start & 63 ? "unaligned" : "64 bytes");
+	IntListFree(&int_list);
+	ListsSetAlign(32);
+	IntListInit(&int_list, reserve, grow);
+	for(i=0; i < push; i++)
+		IntListPush(&int_list, i);
+	printf("Buffer alignment at 32: %s\n", (uintptr_t)int_list.start & 31 ? "unaligned" : "32 bytes");
+	IntListFree(&int_list);
+	ListsSetAlign(0);
+	ListsSetHugePage(0);
+
+	printf("Pushing %lu elements into an address-reserved list.\n", push * 100);
+	IntListInit(&int_list, reserve, grow);
+	if(IntListReserveAddress(&int_list, push * 100)) {
+		IntListPush(&int_list, neg_max);
+		long *first = IntListPointer(&int_list, 0);
+		for(i=1; IntListPush(&int_list, i); i++)
+			;
+		printf("First item: %ld (should be %ld), pointer %s\n", *first, neg_max,
+				first == IntListPointer(&int_list, 0) ? "stable" : "moved");
+		printf("Pushes until full: %s\n", i >= push * 100 ? "at least the reservation" : "short");
+	} else
+		printf("Address reservation unavailable.\n");
+	IntListFree(&int_list);
+
+	printf("Pushing into a list with a budget of %lu elements.\n", push / 2);
+	ListsSetAllocator(test_malloc, test_realloc, test_free);
+	IntListInit(&int_list, reserve, grow);
+	IntListSetBudget(&int_list, push / 2 * sizeof(long));
+	for(i=0; IntListPush(&int_list, i); i++)
+		;
+	printf("Pushes until over budget: %ld (should be %lu), list bytes %zu\n", i, push / 2, IntListBytes(&int_list));
+	IntListSetBudget(&int_list, 0);
+	IntListPush(&int_list, i);
+	IntListRegister(&int_list);
+	printf("Trimmed %zu bytes (should be %lu)\n", ListsTrimAll(), (grow - 1) * sizeof(long));
+	IntListFree(&int_list);
+	ListsSetAllocator(NULL, NULL, NULL);
+	printf("Allocations outstanding through the hooks: %ld (should be 0)\n", test_allocs);
+
+	printf("Parsing \"12, -7, 300000000000, 42\": ");
+	IntListInit(&int_list, reserve, grow);
+	IntListParse(&int_list, "12, -7, 300000000000, 42", 24);
+	IntListWrite(&int_list, stdout, ' ');
+	printf("(should be 12 -7 300000000000 42)\n");
+	FILE *int_out = tmpfile();
+	IntListWriteFd(&int_list, fileno(int_out), ',');
+	rewind(int_out);
+	n = fread(ptr, 1, TMPLEN - 1, int_out);
+	ptr[n] = '\0';
+	printf("Writing the parsed list to a descriptor: \"%s\" (should be \"12,-7,300000000000,42,\")\n", ptr);
+	fclose(int_out);
+
+	/* Large enough to flush the write buffer more than once */
+	FILE *int_file = tmpfile();
+	int_out = tmpfile();
+	IntListInit(&int_dest, 0, grow);
+	for(i=0; i < push; i++)
+		IntListPush(&int_dest, i * 7919 - push);
+	IntListWrite(&int_dest, int_file, ' ');
+	IntListWriteFd(&int_dest, fileno(int_out), ' ');
+	fseek(int_file, 0, SEEK_END);
+	fseek(int_out, 0, SEEK_END);
+	size = ftell(int_file);
+	rewind(int_file);
+	rewind(int_out);
+	for(n=0, r=1; (i = fread(ptr, 1, TMPLEN / 2, int_file)) > 0; n += i)
+		r &= fread(ptr + TMPLEN / 2, 1, TMPLEN / 2, int_out) == (size_t)i && !memcmp(ptr, ptr + TMPLEN / 2, i);
+	printf("Writing %lu elements to a descriptor: %ld bytes, %s (should be %lu bytes, match)\n",
+			IntListSize(&int_dest), n, r ? "match" : "mismatch", size);
+	fclose(int_file);
+	fclose(int_out);
+	IntListFree(&int_dest);
+	IntListFree(&int_list);
+
+	printf("Appending %lu unset elements to a byte-wide list.\n", push);
+	IntListInitWidth(&int_list, reserve, grow, 1);
+	long *space = IntListAppendSpace(&int_list, push);
+	for(i=0; i < push; i++)
+		space[i] = i * 3;
+	IntListGet(&int_list, -1, &r);
+	printf("Last item: %ld (should be %lu)\n", r, (push - 1) * 3);
+	IntListFree(&int_list);
+
+	printf("Resizing a byte-wide list of 3 to %lu unset elements and back.\n", push);
+	IntListInitWidth(&int_list, 0, grow, 1);
+	for(i=0; i < 3; i++)
+		IntListPush(&int_list, i + 1);
+	IntListResizeUninit(&int_list, push);
+	size = IntListSize(&int_list);
+	IntListSet(&int_list, -1, 7);
+	IntListGet(&int_list, -1, &r);
+	IntListResizeUninit(&int_list, 3);
+	IntListGet(&int_list, -1, &n);
+	printf("Sizes: %ld, %ld, last items: %ld, %ld (should be %lu, 3, 7, 3)\n", size, IntListSize(&int_list), r, n, push);
+	IntListFree(&int_list);
+
+	printf("Timing %lu pushes and a rotate.\n", push);
+	unsigned long buckets[LISTS_HISTOGRAM_BUCKETS], calls;
+	ListsHistogramEnable(TRUE);
+	IntListInit(&int_list, reserve, grow);
+	for(i=0; i < push; i++)
+		IntListPush(&int_list, i);
+	IntListRotate(&int_list, 1, 0, 0);
+	ListsHistogramEnable(FALSE);
+	ListsHistogramGet(LISTS_OP_RESERVE, buckets);
+	for(calls=0, i=0; i < LISTS_HISTOGRAM_BUCKETS; i++)
+		calls += buckets[i];
+	printf("Reserve calls timed: %lu (should be %lu)\n", calls, push / grow - 1);
+	ListsHistogramDump(stdout);
+	ListsHistogramReset();
+	IntListFree(&int_list);
+
+	printf("Sorting %lu elements (%lu distinct) in runs of 8192.\n", push * 4, push);
+	long produce_state[2] = { push * 4, push }, consume_state[2] = { 0, 0 };
+	if(IntListExternalSort(int_produce, produce_state, int_consume, consume_state, 8192 * sizeof(long), LISTS_EXTERNAL_UNIQUE))
+		printf("Merged runs: %ld values, last %ld (should be %lu, %lu)\n", consume_state[0], consume_state[1], push, push - 1);
+	else
+		printf("Error.\n");
+
+	printf("Sliding %lu elements through a window of %lu.\n", push, grow);
+	IntListWindowType window;
+	long low, high;
+	IntListWindowInit(&window, grow);
+	printf("Empty window has min: %d, max: %d, item 0: %d (should be 0, 0, 0)\n", IntListWindowMin(&window, NULL),
+			IntListWindowMax(&window, NULL), IntListWindowGet(&window, 0, NULL));
+	for(i=0; i < push; i++)
+		IntListWindowPush(&window, i);
+	IntListWindowMin(&window, &low);
+	IntListWindowMax(&window, &high);
+	printf("Window count %lu, sum %ld, min %ld, max %ld (should be %lu, %lu, %lu, %lu)\n",
+			IntListWindowCount(&window), IntListWindowSum(&window), low, high,
+			grow, (push * 2 - grow - 1) * grow / 2, push - grow, push - 1);
+	printf("Full window has min: %d, max: %d, item -1: %d (should be 1, 1, 1)\n", IntListWindowMin(&window, NULL),
+			IntListWindowMax(&window, NULL), IntListWindowGet(&window, -1, NULL));
+	IntListWindowFree(&window);
+
+	printf("Pushing %lu elements into a segmented list.\n", push);
+	IntSegListType seg_list;
+	IntSegListInit(&seg_list, 0);
+	for(i=0; i < push; i++)
+		IntSegListPush(&seg_list, i);
+	IntSegListInsert(&seg_list, push / 2, neg_max);
+	IntSegListRemove(&seg_list, 0, push / 4);
+	printf("Segmented list: %ld items in %ld blocks\n", IntSegListSize(&seg_list), seg_list.blocks);
+	printf("Searching for '%ld': item %ld (should be %lu)\n", neg_max, IntSegListFind(&seg_list, neg_max), push / 4);
+	IntSegListGet(&seg_list, -1, &r);
+	printf("Last item: %ld (should be %lu)\n", r, push - 1);
+	IntSegListFree(&seg_list);
+
+	printf("Sorting and deduplicating %lu elements (%lu distinct).\n", push * 4, push);
+	IntListInit(&int_list, reserve, grow);
+	for(i=0; i < push * 4; i++)
+		IntListPush(&int_list, (push * 4 - 1 - i) % push);
+	IntListUniqueParallel(&int_list, 0);
+	IntListGet(&int_list, 0, &i);
+	IntListGet(&int_list, -1, &r);
+	printf("Sorted list: %ld items from %ld to %ld (should be %lu from 0 to %lu)\n",
+			IntListSize(&int_list), i, r, push, push - 1);
+	IntListFree(&int_list);
+
+	printf("Intersecting multiples of 2 and 3 below %lu.\n", push);
+	IntListType set_list[2];
+	IntListInit(&set_list[0], reserve, grow);
+	IntListInit(&set_list[1], reserve, grow);
+	for(i=0; i < push; i++) {
+		if(!(i % 2))
+			IntListPush(&set_list[0], i);
+		if(!(i % 3))
+			IntListPush(&set_list[1], i);
+	}
+	IntListInit(&int_list, reserve, grow);
+	IntListIntersect(&int_list, &set_list[0], &set_list[1]);
+	printf("Intersection: %ld items (should be %lu)\n", IntListSize(&int_list), (push + 5) / 6);
+	IntListUnion(&int_list, &set_list[0], &set_list[1]);
+	printf("Union: %ld items (should be %lu)\n", IntListSize(&int_list), (push + 1) / 2 + (push + 2) / 3 - (push + 5) / 6);
+	IntListFree(&set_list[1]);
+	IntListInit(&set_list[1], 0, grow);
+	n = IntListUnion(&int_list, &set_list[0], &set_list[1]);
+	printf("With an empty list: union %s, %ld items (should be %lu); ", n ? "okay" : "error", IntListSize(&int_list), (push + 1) / 2);
+	n = IntListIntersect(&int_list, &set_list[0], &set_list[1]);
+	printf("intersection %s, %ld items (should be 0); ", n ? "okay" : "error", IntListSize(&int_list));
+	n = IntListDifference(&int_list, &set_list[0], &set_list[1]);
+	printf("difference %s, %ld items (should be %lu)\n", n ? "okay" : "error", IntListSize(&int_list), (push + 1) / 2);
+	IntListPtr set_lists[2] = { &set_list[0], &set_list[1] };
+	n = IntListIntersectMany(&int_list, set_lists, 2);
+	printf("Intersecting many with an empty list: %s, %ld items (should be 0)\n", n ? "okay" : "error", IntListSize(&int_list));
+	IntListFree(&set_list[0]);
+	IntListFree(&set_list[1]);
+	IntListFree(&int_list);
+
+	printf("Counting and deduplicating %lu elements (%d distinct).\n", push, 100);
+	IntListInit(&int_list, reserve, grow);
+	for(i=0; i < push; i++)
+		IntListPush(&int_list, (i * 7) % 100);
+	printf("Estimated distinct values: %lu\n", IntListEstimate(&int_list));
+	IntListInit(&set_list[0], reserve, grow);
+	IntListInit(&set_list[1], reserve, grow);
+	IntListCount(&int_list, &set_list[0], &set_list[1], 0);
+	IntListGet(&set_list[1], 0, &r);
+	printf("Distinct values: %ld, first counted %ld times (should be %d, %lu)\n",
+			IntListSize(&set_list[0]), r, 100, (push + 99) / 100);
+	IntListUnique(&int_list, 0);
+	IntListGet(&int_list, 1, &r);
+	printf("Unique list: %ld items, second %ld (should be %d, %d)\n", IntListSize(&int_list), r, 100, 7);
+	IntListFree(&set_list[0]);
+	IntListFree(&set_list[1]);
+	IntListFree(&int_list);
+
+	printf("Converting %lu even numbers to a bitmap.\n", push);
+	BitmapType bitmap;
+	IntListInit(&int_list, reserve, grow);
+	for(i=0; i < push; i++)
+		IntListPush(&int_list, i * 2);
+	BitmapInit(&bitmap);
+	IntListToBitmap(&bitmap, &int_list);
+	printf("Bitmap: %lu items in %lu bytes (list %lu bytes)\n", BitmapCardinality(&bitmap),
+			BitmapBytes(&bitmap), IntListSize(&int_list) * sizeof(long));
+	printf("Contains %d: %d, contains %d: %d (should be 1, 0)\n", 1024, BitmapContains(&bitmap, 1024),
+			1025, BitmapContains(&bitmap, 1025));
+	BitmapToIntList(&int_list, &bitmap);
+	IntListGet(&int_list, -1, &r);
+	printf("Back to list: %ld items, last %ld (should be %lu, %lu)\n", IntListSize(&int_list), r, push, push * 2 - 2);
+	BitmapFree(&bitmap);
+
+	/* Bits, array and run containers on both sides, and a key only one side has */
+	BitmapType bitmap_set[2];
+	BitmapInit(&bitmap_set[0]);
+	BitmapInit(&bitmap_set[1]);
+	for(i=0; i < 10000; i++) {
+		BitmapAdd(&bitmap_set[0], i * 2);
+		BitmapAdd(&bitmap_set[1], i * 3);
+	}
+	for(i=0; i < 100; i++) {
+		BitmapAdd(&bitmap_set[0], 65536 + i * 3);
+		BitmapAdd(&bitmap_set[1], 65536 + i * 2);
+	}
+	for(i=0; i < 30000; i++)
+		BitmapAdd(&bitmap_set[0], 131072 + i);
+	for(i=20000; i < 40000; i++)
+		BitmapAdd(&bitmap_set[1], 131072 + i);
+	BitmapAdd(&bitmap_set[1], 200000);
+	BitmapOptimize(&bitmap_set[0]);
+	BitmapOptimize(&bitmap_set[1]);
+	BitmapInit(&bitmap);
+	BitmapUnion(&bitmap, &bitmap_set[0], &bitmap_set[1]);
+	printf("Bitmap union: %lu items, contains %d: %d, %d: %d (should be 56833, 1, 1)\n", BitmapCardinality(&bitmap),
+			200000, BitmapContains(&bitmap, 200000), 131072 + 39999, BitmapContains(&bitmap, 131072 + 39999));
+	BitmapFree(&bitmap);
+	BitmapInit(&bitmap);
+	BitmapIntersect(&bitmap, &bitmap_set[0], &bitmap_set[1]);
+	printf("Bitmap intersection: %lu items, contains %d: %d, %d: %d (should be 13368, 1, 0)\n", BitmapCardinality(&bitmap),
+			65536 + 6, BitmapContains(&bitmap, 65536 + 6), 14, BitmapContains(&bitmap, 14));
+	BitmapFree(&bitmap);
+	BitmapFree(&bitmap_set[0]);
+	BitmapFree(&bitmap_set[1]);
+	IntListFree(&int_list);
+
+	printf("Pushing %lu elements onto a 4-ary max heap.\n", push);
+	IntListInit(&int_list, reserve, grow);
+	for(i=0; i < push; i++)
+		IntListHeapPush(&int_list, (i * 7919) % push, LISTS_HEAP_MAX | LISTS_HEAP_4ARY);
+	IntListHeapPop(&int_list, &r, LISTS_HEAP_MAX | LISTS_HEAP_4ARY);
+	IntListHeapPeek(&int_list, &i);
+	printf("Popped %ld, next %ld (should be %lu, %lu)\n", r, i, push - 1, push - 2);
+	IntListHeapReplace(&int_list, 0, &r, LISTS_HEAP_MAX | LISTS_HEAP_4ARY);
+	IntListHeapPeek(&int_list, &i);
+	printf("Replaced %ld, next %ld (should be %lu, %lu)\n", r, i, push - 2, push - 3);
+	IntListPartialSort(&int_list, 3, LISTS_HEAP_MIN);
+	printf("Smallest three: ");
+	for(i=0; i < 3; i++) {
+		IntListGet(&int_list, i, &r);
+		printf("%ld ", r);
+	}
+	printf("(should be 0 1 2)\n");
+	IntListFree(&int_list);
+
 
 	printf("\n\n====== Testing Void List ======\n\n");
 
@@ -190,6 +742,39 @@ int main()
 	printf("Freeing list.\n");
 	VoidListFree(&void_list);
 
+	printf("Emplacing a record and handing over another: ");
+	VoidListType void_owned;
+	long *record = lists_malloc(sizeof(long));
+	VoidListInit(&void_owned, 0, grow, sizeof(long), NULL, NULL, NULL, NULL);
+	*(long *)VoidListEmplace(&void_owned, 0) = 1;
+	*record = 2;
+	VoidListPushNoCopy(&void_owned, record);
+	printf("%ld, %ld, same pointer: %s (should be 1, 2, yes)\n", *(long *)void_owned.start[0], *(long *)void_owned.start[1],
+			void_owned.start[1] == record ? "yes" : "no");
+	VoidListFree(&void_owned);
+
+	printf("Pushing %lu records onto a min heap.\n", push);
+	VoidListType void_heap;
+	long top;
+	VoidListInit(&void_heap, 0, grow, sizeof(long), NULL, NULL, NULL, void_long_cmp);
+	for(i=0; i < push; i++) {
+		r = (i * 7919) % push;
+		VoidListHeapPush(&void_heap, &r, 0, LISTS_HEAP_MIN);
+	}
+	VoidListHeapPop(&void_heap, &r, 0, LISTS_HEAP_MIN);
+	n = *(long *)VoidListHeapPeek(&void_heap);
+	printf("Popped %ld, next %ld (should be 0, 1)\n", r, n);
+	r = push;
+	VoidListHeapReplace(&void_heap, &r, 0, &top, LISTS_HEAP_MIN);
+	n = *(long *)VoidListHeapPeek(&void_heap);
+	printf("Replaced %ld with %ld, next %ld (should be 1, %lu, 2)\n", top, r, n, push);
+	VoidListPartialSort(&void_heap, 4, LISTS_HEAP_MAX);
+	printf("Largest four: ");
+	for(i=0; i < 4; i++)
+		printf("%ld ", *(long *)void_heap.start[i]);
+	printf("(should be %lu %lu %lu %lu)\n", push, push - 1, push - 2, push - 3);
+	VoidListFree(&void_heap);
+
 
 	printf("\n\n====== Testing String List ======\n\n");
 
@@ -205,7 +790,7 @@ int main()
 
 	i = -1;
 	printf("Pushing wordlist (max. %lu)\n", i);
-	while(fgets(ptr, 65536, file) && i--) {
+	while(fgets(ptr, TMPLEN, file) && i--) {
 		ptr[strlen(ptr) - 1] = 0;
 		StrListPush(&str_list, ptr);
 		if(StrListSize(&str_list) % grow == 0)
@@ -227,6 +812,184 @@ int main()
 	else
 		printf("not found.\n");
 
+	StrListType str_find;
+	StrListInit(&str_find, 0, grow);
+	StrListPush(&str_find, "alpha");
+	StrListPush(&str_find, "beta");
+	StrListPush(&str_find, "gamma");
+	StrListPush(&str_find, "beta");
+	printf("Finding \"beta\", \"gamma\" and \"delta\": %ld, %ld, %ld (should be 3, 2, -1)\n",
+			StrListFind(&str_find, "beta"), StrListFind(&str_find, "gamma"), StrListFind(&str_find, "delta"));
+	StrListFree(&str_find);
+
+
+	StrListIndexType str_index;
+	long first, count;
+	printf("Indexing list: ");
+	if(StrListIndexBuild(&str_index, &str_list))
+		printf("%lu nodes.\n", str_index.nodes);
+	else
+		printf("Error.\n");
+	printf("Indexed search for \"Hello\": ");
+	if((i = StrListIndexFind(&str_index, "Hello")) >= 0)
+		printf("Found item %ld.\n", i);
+	else
+		printf("not found.\n");
+	printf("Indexed prefix search for \"Hel\": ");
+	if(StrListIndexPrefix(&str_index, "Hel", &first, &count))
+		printf("%ld items, first \"%s\".\n", count,
+				(char *)*StrListPointer(&str_list, StrListIndexGet(&str_index, first)));
+	else
+		printf("not found.\n");
+	StrListIndexFree(&str_index);
+
+	printf("Front coding a sorted copy: ");
+	StrListType str_sorted;
+	StrFrontType str_front;
+	StrListInit(&str_sorted, reserve, grow);
+	StrListCopy(&str_sorted, &str_list, 0, 0);
+	StrListSort(&str_sorted);
+	if(StrListFrontCode(&str_front, &str_sorted))
+		printf("%ld strings in %zu bytes.\n", StrFrontSize(&str_front), StrFrontBytes(&str_front));
+	else
+		printf("Error.\n");
+	StrFrontPrefix(&str_front, "Hel", &first, &count);
+	StrFrontGet(&str_front, first, ptr, TMPLEN);
+	printf("Front coded prefix search for \"Hel\": %ld items, first \"%s\", \"Hello\" is item %ld (should be %ld).\n",
+			count, ptr, StrFrontFind(&str_front, "Hello"), StrListFind(&str_sorted, "Hello"));
+	StrFrontFree(&str_front);
+	long prefix_first;
+	n = StrListFindPrefix(&str_sorted, "Hel", &prefix_first, &size);
+	printf("Sorted list prefix search for \"Hel\": %s, %ld items from %ld (should be found, %ld items from %ld)\n",
+			n ? "found" : "none", size, prefix_first, count, first);
+	n = StrListFindPrefix(&str_sorted, "Helzq", &prefix_first, &size);
+	printf("Prefix search for \"Helzq\": %s, %ld items (should be none, 0 items)\n", n ? "found" : "none", size);
+	n = StrListFindPrefix(&str_sorted, "", &prefix_first, &size);
+	printf("Prefix search for \"\": %s, %ld items from %ld (should be found, %ld items from 0)\n",
+			n ? "found" : "none", size, prefix_first, StrListSize(&str_sorted));
+	StrListFree(&str_sorted);
+
+	printf("Pipeline count of words starting with 'H': ");
+	StrListPipeType str_pipe;
+	StrListPipeInit(&str_pipe, &str_list);
+	StrListPipeFilter(&str_pipe, str_initial, "H");
+	printf("%ld\n", StrListPipeCount(&str_pipe));
+	StrListType str_refused;
+	VoidListInit(&str_refused, 0, 16, 0, str_refuse, NULL, NULL, strlist_cmp);
+	n = StrListPipeCollect(&str_pipe, &str_refused);
+	printf("Collecting them into a list that can't allocate: %s, %ld elements (should be failed, 0)\n",
+			n ? "done" : "failed", StrListSize(&str_refused));
+	StrListFree(&str_refused);
+
+	/* Emplaced strings come from lists_malloc, so only StrListInit lists (which free with lists_free) take them */
+	printf("Emplacing a string and handing over another: ");
+	StrListType str_owned;
+	char *owned = lists_malloc(7);
+	StrListInit(&str_owned, 0, grow);
+	strcpy(StrListEmplace(&str_owned, 5), "first");
+	strcpy(owned, "second");
+	StrListPushNoCopy(&str_owned, owned);
+	StrListWrite(&str_owned, stdout, ' ');
+	printf("same pointer: %s (should be first second same pointer: yes)\n", str_owned.start[1] == owned ? "yes" : "no");
+	FILE *str_out = tmpfile();
+	StrListWriteFd(&str_owned, fileno(str_out), '\n');
+	rewind(str_out);
+	n = fread(ptr, 1, TMPLEN - 1, str_out);
+	ptr[n] = '\0';
+	printf("Writing the strings to a descriptor: %ld bytes, %s (should be 13, first\\nsecond\\n)\n",
+			n, strcmp(ptr, "first\nsecond\n") ? "mismatch" : "first\\nsecond\\n");
+	fclose(str_out);
+	StrListFree(&str_owned);
+
+	printf("Sorting %lu lines (%lu distinct, one longer than the budget) in %d bytes.\n", push * 2 + 2, push + 1, 65536);
+	FILE *str_in = tmpfile();
+	long str_state[2] = { 0, 0 };
+	memset(ptr, 'z', TMPLEN - 1);
+	ptr[TMPLEN - 1] = 0;
+	for(i=0; i < push * 2; i++) {
+		fprintf(str_in, "w%05ld\n", i * 7919 % push);
+		if(i % push == 0)
+			fprintf(str_in, "%s%s\n", ptr, ptr);
+	}
+	rewind(str_in);
+	if(StrListExternalSort(NULL, str_in, str_consume, str_state, 65536, LISTS_EXTERNAL_UNIQUE))
+		printf("Merged string runs: %ld strings, longest %ld (should be %lu, %d)\n", str_state[0], str_state[1], push + 1, (TMPLEN - 1) * 2);
+	else
+		printf("Error.\n");
+	fclose(str_in);
+
+	printf("Pushing %lu words onto a 4-ary max heap.\n", push);
+	StrListType str_heap;
+	StrListInit(&str_heap, 0, grow);
+	for(i=0; i < push; i++) {
+		sprintf(ptr, "w%05ld", i * 7919 % push);
+		StrListHeapPush(&str_heap, ptr, LISTS_HEAP_MAX | LISTS_HEAP_4ARY);
+	}
+	StrListHeapPop(&str_heap, ptr, LISTS_HEAP_MAX | LISTS_HEAP_4ARY);
+	printf("Popped %s, next %s (should be w%05lu, w%05lu)\n", ptr, (char *)StrListHeapPeek(&str_heap), push - 1, push - 2);
+	StrListFree(&str_heap);
+
+	StrListType str_block;
+	StrListInit(&str_block, 0, grow);
+	for(i=0; i < 1000; i++) {
+		sprintf(ptr, "w%03ld", i);
+		StrListPush(&str_block, ptr);
+	}
+	StrListFilterBlock(&str_block, str_keep_block, 64, NULL);
+	printf("Block filter on strings in blocks of 64: %ld kept, first %s, last %s, \"w100\" at %ld, \"w200\" at %ld"
+			" (should be 700, w000, w999, -1, 100)\n", StrListSize(&str_block), (char *)str_block.start[0],
+			(char *)str_block.ptr[-1], StrListFind(&str_block, "w100"), StrListFind(&str_block, "w200"));
+	StrListFree(&str_block);
+
+	printf("Counting and deduplicating %lu strings (%d distinct).\n", push, 100);
+	StrListType str_dup, str_values;
+	IntListType str_counts;
+	StrListInit(&str_dup, 0, grow);
+	for(i=0; i < push; i++) {
+		sprintf(ptr, "w%02ld", i * 7 % 100);
+		StrListPush(&str_dup, ptr);
+	}
+	printf("Estimated distinct strings: %lu (should be about %d)\n", StrListEstimate(&str_dup), 100);
+	StrListInit(&str_values, 0, grow);
+	IntListInit(&str_counts, 0, grow);
+	StrListCount(&str_dup, &str_values, &str_counts, 0);
+	IntListReduce(&str_counts, int_sum, &r, 0, NULL);
+	IntListGet(&str_counts, 1, &n);
+	printf("Distinct strings: %ld, second \"%s\" counted %ld times, %ld in all (should be %d, \"w07\", %lu, %lu)\n",
+			StrListSize(&str_values), (char *)str_values.start[1], n, r, 100, (push + 99) / 100, push);
+	StrListUnique(&str_dup, 0);
+	printf("Unique strings: %ld, first \"%s\", second \"%s\", last \"%s\" (should be %d, \"w00\", \"w07\", \"w93\")\n",
+			StrListSize(&str_dup), (char *)str_dup.start[0], (char *)str_dup.start[1], (char *)str_dup.ptr[-1], 100);
+	StrListFree(&str_dup);
+	StrListFree(&str_values);
+	IntListFree(&str_counts);
+
+	printf("Removing indices 7, 2, 7, -1 from w0-w9: ");
+	StrListType str_remove;
+	IntListType str_indices;
+	StrListInit(&str_remove, 0, grow);
+	IntListInit(&str_indices, 0, grow);
+	for(i=0; i < 10; i++) {
+		sprintf(ptr, "w%ld", i);
+		StrListPush(&str_remove, ptr);
+	}
+	IntListPush(&str_indices, 7);
+	IntListPush(&str_indices, 2);
+	IntListPush(&str_indices, 7);
+	IntListPush(&str_indices, -1);
+	StrListRemoveIndices(&str_remove, &str_indices);
+	StrListWrite(&str_remove, stdout, ' ');
+	printf("(should be w0 w1 w3 w4 w5 w6 w8)\n");
+	IntListSet(&str_indices, 0, 10);
+	n = StrListRemoveIndices(&str_remove, &str_indices);
+	printf("Removing index 10: %s, %ld left (should be rejected, 7)\n", n ? "done" : "rejected", StrListSize(&str_remove));
+	printf("Swap removing the first, then the odd ones: ");
+	StrListSwapRemove(&str_remove, 0);
+	StrListRemoveIf(&str_remove, str_odd, NULL);
+	StrListWrite(&str_remove, stdout, ' ');
+	printf("(should be w8 w4 w6)\n");
+	StrListFree(&str_remove);
+	IntListFree(&str_indices);
 
 	printf("Pushing another %lu elements.\n", push);
 	for(i=0; i < push; i++) {
@@ -253,6 +1016,11 @@ int main()
 	str_getset(&str_list, size - 1, text, text2);
 	str_getset(&str_list, size, text, NULL);
 
+	n = StrListGetN(&str_list, 0, ptr, 6);
+	printf("Bounded get of item 0 into 6 bytes: %s, %s", ptr, n ? "fits" : "truncated");
+	n = StrListGetN(&str_list, 0, ptr, strlen(text) + 1);
+	printf("; into %lu bytes: %s, %s (should be Hello, truncated; %s, fits)\n", strlen(text) + 1, ptr, n ? "fits" : "truncated", text);
+
 	n = size >> 2;
 	printf("Removing first %lu/%lu element(s): ", n, StrListSize(&str_list));
 	if(StrListRemove(&str_list, 0, n))
@@ -268,5 +1036,97 @@ int main()
 	printf("Freeing list.\n");
 	StrListFree(&str_list);
 
+
+	printf("\n\n====== Testing Interned String List ======\n\n");
+
+	StrInternType intern;
+
+	StrInternInit(&intern, 0);
+	StrListInitIntern(&str_list, reserve, grow, &intern);
+	StrListDump(&str_list, stdout, 0);
+
+	printf("Pushing %lu elements.\n", push);
+	for(i=0; i < push; i++)
+		StrListPush(&str_list, i & 1 ? text2 : text);
+	StrListDump(&str_list, stdout, 0);
+	printf("Interned strings: %ld (should be 2)\n", StrInternSize(&intern));
+
+	printf("Searching for \"%s\": ", text);
+	if((i = StrListFind(&str_list, text)) >= 0)
+		printf("Found item %ld.\n", i);
+	else
+		printf("not found.\n");
+
+	printf("Freeing list.\n");
+	StrListFree(&str_list);
+	printf("Interned strings: %ld (should be 0)\n", StrInternSize(&intern));
+	StrInternFree(&intern);
+
+
+	printf("\n\n====== Testing Hashed String List ======\n\n");
+
+	StrListInitHashed(&str_list, reserve, grow);
+	StrListDump(&str_list, stdout, 0);
+
+	printf("Pushing %lu elements.\n", push);
+	for(i=0; i < push; i++)
+		StrListPush(&str_list, i & 1 ? text2 : text);
+	StrListDump(&str_list, stdout, 0);
+
+	printf("Searching for \"%s\": ", text);
+	if((i = StrListFind(&str_list, text)) >= 0)
+		printf("Found item %ld.\n", i);
+	else
+		printf("not found.\n");
+
+	str_getset(&str_list, 0, text2, text);
+	printf("Bounded get into %d bytes: ", 6);
+	if(!StrListGetN(&str_list, 1, ptr, 6))
+		printf("%s (truncated)\n", ptr);
+
+	printf("Freeing list.\n");
+	StrListFree(&str_list);
+
+
+	printf("\n\n====== Testing String Map ======\n\n");
+
+	StrMapType str_map;
+	StrMapInit(&str_map, 0);
+
+	printf("Putting %lu keys.\n", push);
+	for(i=0; i < push; i++) {
+		sprintf(ptr, "key%ld", i);
+		StrMapPut(&str_map, ptr, i * 2);
+	}
+	printf("Map size: %ld (should be %lu)\n", StrMapSize(&str_map), push);
+	if(StrMapGet(&str_map, "key100", &r))
+		printf("Get \"key100\": %ld (should be 200)\n", r);
+	else
+		printf("Error.\n");
+	for(i=0; i < push; i += 2) {
+		sprintf(ptr, "key%ld", i);
+		StrMapDelete(&str_map, ptr);
+	}
+	printf("Deleted even keys, size: %ld (should be %lu), \"key100\" %s\n", StrMapSize(&str_map), push / 2,
+			StrMapGet(&str_map, "key100", NULL) ? "found" : "gone");
+	StrListInit(&str_list, reserve, grow);
+	StrMapKeys(&str_map, &str_list);
+	printf("Exported keys: %ld\n", StrListSize(&str_list));
+	StrListFree(&str_list);
+	StrMapFree(&str_map);
+
+	StrMapInitPayload(&str_map, 0, sizeof(long), map_alloc, NULL, NULL);
+	r = 1;
+	StrMapPutValue(&str_map, "one", &r);
+	map_refuse = TRUE;
+	r = 2;
+	n = StrMapPutValue(&str_map, "one", &r);
+	size = StrMapPutValue(&str_map, "two", &r);
+	map_refuse = FALSE;
+	StrMapGetValue(&str_map, "one", &r);
+	printf("Updates without memory: %s/%s, \"one\" is %ld, size %ld (should be failed/failed, 1, 1)\n",
+			n ? "done" : "failed", size ? "done" : "failed", r, StrMapSize(&str_map));
+	StrMapFree(&str_map);
+
 	return(0);
 }